@@ -0,0 +1,267 @@
+// bootstrap benchmark: times YieldCurvesBootstrap<Traits, Interpolator> bootstrap, verify, and curve queries
+// for every traits x interpolator combination on synthetic instrument sets of several curve lengths
+// output is one CSV record per (combination, instrument mix, curve length, phase) on stdout:
+// traits,interpolator,mix,max_tenor,instruments,phase,repetitions,mean_us,min_us,status
+// usage: bootstrap-benchmark [repetitions=20]
+// build: g++ -std=c++17 -O2 -I<repo root> benchmarks/bootstrap-benchmark.cpp -lQuantLib -pthread
+#include <ql/quantlib.hpp>
+#include <ql_utils/all.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <cmath>
+
+using namespace QuantLib;
+using namespace QuantLib::Utils;
+
+namespace {
+    typedef Bootstrapper::pInstrument pInstrument;
+    typedef Bootstrapper::Instruments Instruments;
+    typedef Bootstrapper::pInstruments pInstruments;
+
+    // smooth, upward sloping reference curve the synthetic quotes are implied from
+    ext::shared_ptr<YieldTermStructure> referenceCurve(const Date& today) {
+        std::vector<Date> dates;
+        std::vector<Rate> zeros;
+        for (Integer m = 0; m <= 12 * 60; ++m) {
+            auto t = m / 12.0;
+            dates.push_back(today + m * Months);
+            zeros.push_back(0.035 + 0.012 * (1.0 - std::exp(-t / 4.0)) - 0.004 * t * std::exp(-t / 2.0));
+        }
+        ext::shared_ptr<YieldTermStructure> ts(new ZeroCurve(dates, zeros, Actual365Fixed()));
+        ts->enableExtrapolation();
+        return ts;
+    }
+
+    std::vector<Period> swapTenors(const Period& maxTenor, Integer firstYear) {
+        std::vector<Period> ret;
+        for (Integer y : {2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 15, 20, 25, 30, 40, 50}) {
+            if (y >= firstYear && y * Years <= maxTenor) {
+                ret.push_back(y * Years);
+            }
+        }
+        return ret;
+    }
+
+    // SOFR deposit + SOFR OIS swaps
+    pInstruments sofrOISMix(const Period& maxTenor) {
+        typedef QLUtils::OISSwapIndex<UsdOvernightIndexedSwapIsdaFix<Sofr>> SofrOIS;
+        pInstruments instruments(new Instruments());
+        instruments->emplace_back(new QLUtils::IborIndexCashDeposit<Sofr>());
+        for (Integer m : {1, 2, 3, 6, 9, 12, 18}) {
+            instruments->emplace_back(new SofrOIS(m * Months));
+        }
+        for (const auto& tenor : swapTenors(maxTenor, 2)) {
+            instruments->emplace_back(new SofrOIS(tenor));
+        }
+        return instruments;
+    }
+
+    // term SOFR 3M deposit + IMM futures strip + term SOFR 3M vanilla swaps
+    pInstruments futuresMix(const Period& maxTenor) {
+        QLUtils::IborIndexFactory factory = [](const Handle<YieldTermStructure>& h) {return ext::shared_ptr<IborIndex>(new TermSofr3M(h));};
+        pInstruments instruments(new Instruments());
+        instruments->emplace_back(new QLUtils::IborIndexCashDeposit<TermSofr3M>());
+        for (Natural ordinal = 1; ordinal <= 8; ++ordinal) {
+            instruments->emplace_back(new QLUtils::IMMFuture(factory, ordinal));
+        }
+        for (const auto& tenor : swapTenors(maxTenor, 3)) {
+            instruments->emplace_back(new QLUtils::VanillaSwapIndex<UsdTermSofrSwapIsdaFix<Quarterly>>(tenor));
+        }
+        return instruments;
+    }
+
+    // term SOFR 3M deposit + FRAs + term SOFR 3M vanilla swaps
+    pInstruments fraMix(const Period& maxTenor) {
+        QLUtils::IborIndexFactory factory = [](const Handle<YieldTermStructure>& h) {return ext::shared_ptr<IborIndex>(new TermSofr3M(h));};
+        pInstruments instruments(new Instruments());
+        instruments->emplace_back(new QLUtils::IborIndexCashDeposit<TermSofr3M>());
+        for (Integer m = 3; m <= 21; m += 3) {
+            instruments->emplace_back(new QLUtils::FRA(factory, m * Months));
+        }
+        for (const auto& tenor : swapTenors(maxTenor, 3)) {
+            instruments->emplace_back(new QLUtils::VanillaSwapIndex<UsdTermSofrSwapIsdaFix<Quarterly>>(tenor));
+        }
+        return instruments;
+    }
+
+    // par treasury bonds
+    pInstruments parBondMix(const Period& maxTenor) {
+        pInstruments instruments(new Instruments());
+        for (Integer m : {6, 12}) {
+            instruments->emplace_back(new QLUtils::ParSpot<>(m * Months));
+        }
+        for (const auto& tenor : swapTenors(maxTenor, 2)) {
+            instruments->emplace_back(new QLUtils::ParSpot<>(tenor));
+        }
+        return instruments;
+    }
+
+    // sets every instrument's quote to its implied quote on the reference curve
+    void setQuotes(const Instruments& instruments, const ext::shared_ptr<YieldTermStructure>& ts) {
+        Handle<YieldTermStructure> h(ts);
+        for (const auto& inst : instruments) {
+            inst->value() = inst->impliedQuote(h, h);
+        }
+    }
+
+    struct Timing {
+        Size repetitions;
+        double meanMicroseconds;
+        double minMicroseconds;
+        std::string status;
+    };
+
+    Timing measure(Size repetitions, const std::function<void()>& f) {
+        typedef std::chrono::steady_clock Clock;
+        Timing ret{0, 0.0, std::numeric_limits<double>::max(), "ok"};
+        double total = 0.0;
+        try {
+            for (Size i = 0; i < repetitions; ++i) {
+                auto start = Clock::now();
+                f();
+                auto us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                total += us;
+                ret.minMicroseconds = std::min(ret.minMicroseconds, us);
+                ++ret.repetitions;
+            }
+        }
+        catch (const std::exception& e) {
+            ret.status = std::string("error: ") + e.what();
+        }
+        if (ret.repetitions == 0) {
+            ret.minMicroseconds = 0.0;
+        }
+        else {
+            ret.meanMicroseconds = total / ret.repetitions;
+        }
+        return ret;
+    }
+
+    std::string csvField(const std::string& s) {
+        std::string ret = "\"";
+        for (auto c : s) {
+            if (c == '"') {
+                ret += '"';
+            }
+            ret += c;
+        }
+        return ret + "\"";
+    }
+
+    struct Case {
+        std::string traits;
+        std::string interpolator;
+        std::string mix;
+        Period maxTenor;
+        Size instruments;
+    };
+
+    void report(const Case& c, const std::string& phase, const Timing& t) {
+        std::cout << c.traits << "," << c.interpolator << "," << c.mix << "," << c.maxTenor << "," << c.instruments;
+        std::cout << "," << phase << "," << t.repetitions << "," << t.meanMicroseconds << "," << t.minMicroseconds;
+        std::cout << "," << csvField(t.status) << '\n';
+    }
+
+    template <typename Traits, typename Interpolator>
+    void benchmark(
+        const std::string& traitsName,
+        const std::string& interpolatorName,
+        const std::string& mixName,
+        const Period& maxTenor,
+        const pInstruments& instruments,
+        const Date& today,
+        Size repetitions
+    ) {
+        Case c{traitsName, interpolatorName, mixName, maxTenor, instruments->size()};
+        YieldCurvesBootstrap<Traits, Interpolator> bootstrap;
+        bootstrap.instruments = instruments;
+        auto t = measure(repetitions, [&]() {
+            bootstrap.bootstrap(today);
+        });
+        report(c, "bootstrap", t);
+        if (t.status != "ok") {
+            return;
+        }
+        Bootstrapper::VerificationReport verification;
+        report(c, "verify", measure(repetitions, [&]() {
+            bootstrap.verify(verification);
+        }));
+        std::ostringstream oss;
+        report(c, "verify_text", measure(repetitions, [&]() {
+            oss.str(std::string());
+            bootstrap.verify(oss);
+        }));
+        const auto& curve = bootstrap.estimatingCurve;
+        auto maxTime = curve->maxTime();
+        report(c, "query_1000", measure(repetitions, [&]() {
+            Real sum = 0.0;
+            for (Size i = 1; i <= 1000; ++i) {
+                auto s = maxTime * i / 1000.0;
+                sum += curve->discount(s);
+                sum += curve->zeroRate(s, Continuous).rate();
+                sum += curve->forwardRate(s * 0.99, s, Continuous).rate();
+            }
+            if (sum == Null<Real>()) {  // keep the queries from being optimized away
+                std::cerr << sum;
+            }
+        }));
+    }
+
+    template <typename Traits>
+    void benchmarkInterpolators(
+        const std::string& traitsName,
+        const std::string& mixName,
+        const Period& maxTenor,
+        const pInstruments& instruments,
+        const Date& today,
+        Size repetitions
+    ) {
+        benchmark<Traits, Linear>(traitsName, "Linear", mixName, maxTenor, instruments, today, repetitions);
+        benchmark<Traits, BackwardFlat>(traitsName, "BackwardFlat", mixName, maxTenor, instruments, today, repetitions);
+        benchmark<Traits, ConvexMonotone>(traitsName, "ConvexMonotone", mixName, maxTenor, instruments, today, repetitions);
+        benchmark<Traits, LogLinear>(traitsName, "LogLinear", mixName, maxTenor, instruments, today, repetitions);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Size repetitions = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20);
+    if (repetitions == 0) {
+        repetitions = 1;
+    }
+    Date today(15, March, 2024);
+    Settings::instance().evaluationDate() = today;
+    auto ts = referenceCurve(today);
+    std::vector<std::pair<std::string, std::function<pInstruments(const Period&)>>> mixes = {
+        {"sofr_ois", sofrOISMix},
+        {"futures_swaps", futuresMix},
+        {"fra_swaps", fraMix},
+        {"par_bonds", parBondMix}
+    };
+    std::cout << "traits,interpolator,mix,max_tenor,instruments,phase,repetitions,mean_us,min_us,status" << '\n';
+    for (const auto& mix : mixes) {
+        for (const auto& maxTenor : {10 * Years, 30 * Years, 50 * Years}) {
+            pInstruments instruments;
+            try {
+                instruments = mix.second(maxTenor);
+                setQuotes(*instruments, ts);
+            }
+            catch (const std::exception& e) {
+                std::cerr << mix.first << " " << maxTenor << ": " << e.what() << std::endl;
+                continue;
+            }
+            benchmarkInterpolators<ZeroYield>("ZeroYield", mix.first, maxTenor, instruments, today, repetitions);
+            benchmarkInterpolators<Discount>("Discount", mix.first, maxTenor, instruments, today, repetitions);
+            benchmarkInterpolators<ForwardRate>("ForwardRate", mix.first, maxTenor, instruments, today, repetitions);
+            benchmarkInterpolators<SimpleZeroYield>("SimpleZeroYield", mix.first, maxTenor, instruments, today, repetitions);
+        }
+    }
+    std::cout.flush();
+    return 0;
+}
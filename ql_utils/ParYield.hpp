@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ql/quantlib.hpp>
+#include <ql_utils/valuation-context.hpp>
 
 namespace QLUtils {
     // functor that determines whether the given bond tenor is a par couponed bond based on a cutoff months
@@ -26,6 +27,7 @@ namespace QLUtils {
         QuantLib::Period timeToMaturity_;    // bond time to maturity from settlement date
         QuantLib::Period forwardSettlePeriod_;  // forward settle period
         QuantLib::Date baseReferenceDate_;  // base reference date
+        ValuationContext valuationContext_; // provides today
 
         QuantLib::Date settlementDate_; // bond settlement date
         QuantLib::Natural settlementDays_;  // bond # of days to settle from today
@@ -43,7 +45,7 @@ namespace QLUtils {
         }
     protected:
         void initialize() {
-            QuantLib::Date today = QuantLib::Settings::instance().evaluationDate();
+            QuantLib::Date today = valuationContext_.evaluationDate();
             auto baseReferenceDate = (baseReferenceDate_ == QuantLib::Date() ? today : baseReferenceDate_);
             QL_REQUIRE(baseReferenceDate >= today, "base reference date must be greater or equal to today");
             settlementDate_ = baseReferenceDate + forwardSettlePeriod_;
@@ -72,11 +74,13 @@ namespace QLUtils {
         TheoreticalBondScheduler(
             const QuantLib::Period& timeToMaturity,    // bond time to maturity from settlement date
             const QuantLib::Period& forwardSettlePeriod = QuantLib::Period(0, QuantLib::Days),   // forward settle period
-            const QuantLib::Date& baseReferenceDate = QuantLib::Date()    // base reference date
+            const QuantLib::Date& baseReferenceDate = QuantLib::Date(),    // base reference date
+            const ValuationContext& valuationContext = ValuationContext()   // provides today
         ) :
             timeToMaturity_(timeToMaturity),
             forwardSettlePeriod_(forwardSettlePeriod),
             baseReferenceDate_(baseReferenceDate),
+            valuationContext_(valuationContext),
             settlementDate_(QuantLib::Date()),
             settlementDays_(QuantLib::Null<QuantLib::Natural>()),
             maturityDate_(QuantLib::Date()),
@@ -96,6 +100,9 @@ namespace QLUtils {
         const QuantLib::Date& baseReferenceDate() const {
             return baseReferenceDate_;
         }
+        const ValuationContext& valuationContext() const {
+            return valuationContext_;
+        }
         const QuantLib::Date& settlementDate() const {
             return settlementDate_;
         }
@@ -131,6 +138,7 @@ namespace QLUtils {
         QuantLib::Rate parYield_;   // par yield/coupon rate for the fixed rate bond
         QuantLib::Date baseReferenceDate_;  // base reference date for calculating the fixed rate bond schedule
         QuantLib::Period forwardStart_; // forward starting fixed rate bond from the base reference date
+        ValuationContext valuationContext_; // provides today
     public:
         ParYieldHelper(
             const QuantLib::Period& tenor
@@ -152,6 +160,9 @@ namespace QLUtils {
         const QuantLib::Period& forwardStart() const {
             return forwardStart_;
         }
+        const ValuationContext& valuationContext() const {
+            return valuationContext_;
+        }
         ParYieldHelper& withParYield(
             const QuantLib::Rate& parYield
         ) {
@@ -170,6 +181,12 @@ namespace QLUtils {
             forwardStart_ = forwardStart;
             return *this;
         }
+        ParYieldHelper& withValuationContext(
+            const ValuationContext& valuationContext
+        ) {
+            valuationContext_ = valuationContext;
+            return *this;
+        }
         bool parYieldIsSet() const {
             return (parYield_ != QuantLib::Null<QuantLib::Rate>());
         }
@@ -194,7 +211,7 @@ namespace QLUtils {
         // create spot FixedRateBondHelper for discount curve bootstraping (par yield => zero curve)
         operator FixedRateBondHelperPtr() const {
             ensureParYieldIsSet();
-            ParBondScheduler parBondSched(tenor(), forwardStart(), baseReferenceDate()); // for theoretical bond settle on the spot
+            ParBondScheduler parBondSched(tenor(), forwardStart(), baseReferenceDate(), valuationContext()); // for theoretical bond settle on the spot
             auto const& schedule = parBondSched.schedule();
             auto const& settlementDate = parBondSched.settlementDate();
             auto const& maturityDate = parBondSched.maturityDate();
@@ -244,10 +261,11 @@ namespace QLUtils {
         static QuantLib::Rate parYield(
             const YieldTermStructurePtr& discountTermStructure,
             const QuantLib::Period & tenor,
-            const QuantLib::Period& forwardTerm = QuantLib::Period(0, QuantLib::Days)
+            const QuantLib::Period& forwardTerm = QuantLib::Period(0, QuantLib::Days),
+            const ValuationContext& valuationContext = ValuationContext()   // provides today
         ) {
             QL_REQUIRE(discountTermStructure != nullptr, "discount term structure not set");
-            ParBondScheduler parBondSched(tenor, forwardTerm, discountTermStructure->referenceDate());
+            ParBondScheduler parBondSched(tenor, forwardTerm, discountTermStructure->referenceDate(), valuationContext);
             auto const& schedule = parBondSched.schedule();
             auto const& settlementDate = parBondSched.settlementDate();
             auto const& maturityDate = parBondSched.maturityDate();
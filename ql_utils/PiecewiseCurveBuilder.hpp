@@ -1,13 +1,18 @@
 #pragma once
 #include <vector>
 #include <ql/quantlib.hpp>
+#include <ql_utils/termstructures/yield/suffixiterativebootstrap.hpp>
+#include <ql_utils/bootstrap-diagnostics.hpp>
+#include <chrono>
+#include <exception>
 
 namespace QLUtils {
     // the main curve bootstrapper
-    // T = traits, I = interpolation
-    template<typename T, typename I>
+    // T = traits, I = interpolation, B = bootstrap (QuantLib::IterativeBootstrap, or QuantLib::Utils::SuffixIterativeBootstrap for quote updates that only re-solve the pillars after the first changed quote)
+    template<typename T, typename I, template<class> class B = QuantLib::IterativeBootstrap>
     class PiecewiseCurveBuilder {
     public:
+        typedef QuantLib::PiecewiseYieldCurve<T, I, B> CurveType;
         typedef QuantLib::ext::shared_ptr<QuantLib::Quote> pQuote;
         typedef QuantLib::ext::shared_ptr<QuantLib::IborIndex> pIborIndex;
         typedef QuantLib::ext::shared_ptr<QuantLib::OvernightIndex> pOvernightIndex;
@@ -16,10 +21,15 @@ namespace QLUtils {
         typedef QuantLib::ext::shared_ptr<QuantLib::RateHelper> pRateHelper;
         typedef QuantLib::Handle<QuantLib::Quote> QuoteHandle;
         typedef QuantLib::Handle<QuantLib::YieldTermStructure> YieldTermStructureHandle;
+        typedef QuantLib::ext::shared_ptr<QuantLib::InstrumentedRateHelper> pInstrumentedRateHelper;
     protected:
         std::vector<pRateHelper> rateHelpers;
+        std::vector<pInstrumentedRateHelper> instrumentedHelpers;   // wrappers the curve was built with when diagnostics were requested, one for one with rateHelpers
     public:
         PiecewiseCurveBuilder() {}
+        const std::vector<pRateHelper>& helpers() const {
+            return rateHelpers;
+        }
         QuantLib::ext::shared_ptr<QuantLib::DepositRateHelper> AddDeposit(
             const pQuote& quote,
             const pIborIndex& iborIndex
@@ -161,14 +171,69 @@ namespace QLUtils {
             return rateHelper;
         }
         // T = traits, I = interpolation
-        QuantLib::ext::shared_ptr<QuantLib::PiecewiseYieldCurve<T, I>> GetCurve(
+        // if diagnostics is given, the curve is built with instrumented helpers and the diagnostics are filled (also when the bootstrap fails)
+        QuantLib::ext::shared_ptr<CurveType> GetCurve(
             const QuantLib::Date& curveReferenceDate,
             const QuantLib::DayCounter& dayCounter,
-            const I& interp = I()   // custom interpretor of type I
+            const I& interp = I(),  // custom interpretor of type I
+            BootstrapDiagnostics* diagnostics = nullptr
         ) {
-            QuantLib::ext::shared_ptr<QuantLib::PiecewiseYieldCurve<T, I>> pTS(new QuantLib::PiecewiseYieldCurve<T, I>(curveReferenceDate, rateHelpers, dayCounter, interp));
-            pTS->discount(0);   // trigger the bootstrap
+            typedef std::chrono::steady_clock Clock;
+            instrumentedHelpers.clear();
+            if (diagnostics == nullptr) {
+                QuantLib::ext::shared_ptr<CurveType> pTS(new CurveType(curveReferenceDate, rateHelpers, dayCounter, interp));
+                pTS->discount(0);   // trigger the bootstrap
+                return pTS;
+            }
+            auto helperConstructionSeconds = diagnostics->helperConstructionSeconds;
+            diagnostics->clear();
+            diagnostics->helperConstructionSeconds = helperConstructionSeconds;
+            auto start = Clock::now();
+            std::vector<pRateHelper> curveHelpers;
+            for (const auto& rateHelper : rateHelpers) {
+                instrumentedHelpers.emplace_back(new QuantLib::InstrumentedRateHelper(rateHelper));
+                curveHelpers.push_back(instrumentedHelpers.back());
+            }
+            QuantLib::ext::shared_ptr<CurveType> pTS(new CurveType(curveReferenceDate, curveHelpers, dayCounter, interp));
+            diagnostics->curveConstructionSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+            SolveCurve(pTS, diagnostics);
             return pTS;
         }
+        // (re-)trigger the bootstrap of a curve returned by GetCurve(), e.g. after quote updates
+        // per helper statistics are only available if the curve was built with diagnostics
+        void SolveCurve(
+            const QuantLib::ext::shared_ptr<CurveType>& pTS,
+            BootstrapDiagnostics* diagnostics = nullptr
+        ) const {
+            if (diagnostics == nullptr) {
+                pTS->discount(0);   // trigger the bootstrap
+                return;
+            }
+            typedef std::chrono::steady_clock Clock;
+            for (const auto& instrumented : instrumentedHelpers) {
+                instrumented->resetStatistics();
+            }
+            diagnostics->succeeded = false;
+            diagnostics->error.clear();
+            auto start = Clock::now();
+            std::exception_ptr error;
+            try {
+                pTS->discount(0);   // trigger the bootstrap
+                diagnostics->succeeded = true;
+            }
+            catch (const std::exception& e) {
+                diagnostics->error = e.what();
+                error = std::current_exception();
+            }
+            catch (...) {
+                diagnostics->error = "unknown error";
+                error = std::current_exception();
+            }
+            diagnostics->solveSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+            diagnostics->collect(instrumentedHelpers);
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
     };
 }
\ No newline at end of file
@@ -1,21 +1,30 @@
 #pragma once
 
 #include <ql_utils/types.hpp>
+#include <ql_utils/valuation-context.hpp>
 #include <ql_utils/dateformat.hpp>
 #include <ql_utils/fixing-date-adjustment.hpp>
 #include <ql_utils/ParYield.hpp>
 #include <ql_utils/monthly-moving-average-proj.hpp>
+#include <ql_utils/bootstrap-diagnostics.hpp>
 #include <ql_utils/PiecewiseCurveBuilder.hpp>
 #include <ql_utils/swap-index-traits.hpp>
 #include <ql_utils/instrument.hpp>
 #include <ql_utils/fixed-rate-bond-securities.hpp>
+#include <ql_utils/rate-helper-cache.hpp>
 #include <ql_utils/bootstrap.hpp>
+#include <ql_utils/curve-jacobian.hpp>
+#include <ql_utils/fitted-yield-curve-bootstrap.hpp>
+#include <ql_utils/joint-yield-curves-bootstrap.hpp>
 #include <ql_utils/interpolation-traits.hpp>
 #include <ql_utils/bootstrap-quote.hpp>
 #include <ql_utils/yield-termstructure-shocker.hpp>
 #include <ql_utils/monthly-yield-termstructure-shocker.hpp>
 #include <ql_utils/instantaneous-fwd-yield-curve-shocker.hpp>
 #include <ql_utils/curves-forward-spread-calculator.hpp>
+#include <ql_utils/yield-curve-set-bootstrap.hpp>
+#include <ql_utils/historical-batch-bootstrap.hpp>
+#include <ql_utils/yield-curve-cache.hpp>
 #include <ql_utils/interpolated-yield-ts-serialization.hpp>
 #include <ql_utils/paryieldsplinebootstrap.hpp>
 #include <ql_utils/swap-fixing.hpp>
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/ratehelpers/instrumented-ratehelper.hpp>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace QLUtils {
+    // record of how a piecewise curve bootstrap went, filled when requested by PiecewiseCurveBuilder::GetCurve() / SolveCurve()
+    struct BootstrapDiagnostics {
+        struct Helper {
+            QuantLib::Date pillarDate;
+            QuantLib::Date maturityDate;
+            QuantLib::Real quote;
+            QuantLib::Size evaluations; // implied quote calculations made by the solver, i.e. solver function evaluations of the helper's pillar
+            double seconds; // wall time spent repricing the helper, i.e. the solve time of its pillar
+            QuantLib::Real residual;    // quote - implied quote on the solved curve
+            Helper() : quote(QuantLib::Null<QuantLib::Real>()), evaluations(0), seconds(0.0), residual(QuantLib::Null<QuantLib::Real>()) {}
+        };
+        bool succeeded;
+        std::string error;
+        double helperConstructionSeconds;   // building the rate helpers (filled by YieldCurvesBootstrap)
+        double curveConstructionSeconds;    // building the piecewise curve
+        double solveSeconds;    // the bootstrap itself
+        QuantLib::Size evaluations; // total implied quote calculations
+        QuantLib::Real maxAbsResidual;
+        std::vector<Helper> helpers;    // per helper statistics, in the order the helpers were added to the builder. empty if the curve was not built with diagnostics
+        BootstrapDiagnostics() {
+            clear();
+        }
+        void clear() {
+            succeeded = false;
+            error.clear();
+            helperConstructionSeconds = 0.0;
+            curveConstructionSeconds = 0.0;
+            solveSeconds = 0.0;
+            evaluations = 0;
+            maxAbsResidual = QuantLib::Null<QuantLib::Real>();
+            helpers.clear();
+        }
+        double totalSeconds() const {
+            return helperConstructionSeconds + curveConstructionSeconds + solveSeconds;
+        }
+        // index of the helper that took the longest to solve (helpers.size() if there is none)
+        QuantLib::Size slowestHelper() const {
+            auto ret = helpers.size();
+            for (QuantLib::Size i = 0; i < helpers.size(); ++i) {
+                if (ret == helpers.size() || helpers[i].seconds > helpers[ret].seconds) {
+                    ret = i;
+                }
+            }
+            return ret;
+        }
+        // fills the per helper statistics from the instrumented helpers of a solved curve
+        void collect(
+            const std::vector<QuantLib::ext::shared_ptr<QuantLib::InstrumentedRateHelper>>& instrumentedHelpers
+        ) {
+            helpers.resize(instrumentedHelpers.size());
+            evaluations = 0;
+            maxAbsResidual = (instrumentedHelpers.empty() ? QuantLib::Null<QuantLib::Real>() : 0.0);
+            for (QuantLib::Size i = 0; i < instrumentedHelpers.size(); ++i) {
+                const auto& instrumented = instrumentedHelpers[i];
+                auto& helper = helpers[i];
+                helper.pillarDate = instrumented->pillarDate();
+                helper.maturityDate = instrumented->maturityDate();
+                helper.quote = instrumented->quote()->value();
+                helper.evaluations = instrumented->evaluations();
+                helper.seconds = instrumented->seconds();
+                helper.residual = (succeeded ? instrumented->residual() : QuantLib::Null<QuantLib::Real>());
+                evaluations += helper.evaluations;
+                if (helper.residual != QuantLib::Null<QuantLib::Real>()) {
+                    maxAbsResidual = std::max(maxAbsResidual, std::abs(helper.residual));
+                }
+            }
+        }
+    };
+}
@@ -3,13 +3,17 @@
 #include <ql/quantlib.hpp>
 #include <ql_utils/PiecewiseCurveBuilder.hpp>
 #include <ql_utils/instrument.hpp>
+#include <ql_utils/rate-helper-cache.hpp>
+#include <ql_utils/valuation-context.hpp>
 #include <ql_utils/dateformat.hpp>
 #include <ql_utils/types.hpp>
+#include <ql_utils/utilities/thread-pool.hpp>
 #include <memory>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <chrono>
 
 namespace QuantLib {
     namespace Utils {
@@ -38,10 +42,41 @@ namespace QuantLib {
                     os << "," << "actual=" << actual * inst.valueMultiplier();
                     os << "," << "implied=" << implied * inst.valueMultiplier();
                     os << "," << "diff=" << diff * inst.basisPointDiffMultiplier() << " bp";
-                    os << std::endl;
+                    os << '\n';
                     return diff * inst.absoluteDiffMultiplier();
                 }
             };
+            struct VerificationRecord {
+                pInstrument instrument;
+                Real actual;
+                Real implied;
+                Real diff;  // implied - actual
+                Rate error; // diff * absoluteDiffMultiplier(), the instrument's term of the verification error
+            };
+            // structured result of a verification, with no text formatting
+            // the records are resized in place, so a report reused across verifications of the same instruments does not allocate
+            class VerificationReport {
+            public:
+                std::vector<VerificationRecord> records;    // one per used instrument, in input order
+                Rate error; // sqrt of the sum of the squared record errors, as returned by the ostream verify()
+            public:
+                VerificationReport() : error(0.0) {}
+                // optional text rendering, in the same format as the ostream verify()
+                template<
+                    typename ActualVsImpliedComparison = DefaultActualVsImpliedComparison
+                >
+                void render(
+                    std::ostream& os,
+                    std::streamsize precision = 16,
+                    const ActualVsImpliedComparison& compare = ActualVsImpliedComparison()
+                ) const {
+                    os << std::fixed;
+                    os << std::setprecision(precision);
+                    for (const auto& record : records) {
+                        compare(os, *record.instrument, record.actual, record.implied);
+                    }
+                }
+            };
         protected:
             template <
                 typename ImpliedValueCalculator,
@@ -67,6 +102,59 @@ namespace QuantLib {
                 }
                 return std::sqrt(err);
             }
+            // fills the report without any formatting. with a pool of more than one thread the implied values are calculated in
+            // parallel, which requires the implied value calculator to be thread safe: the curves must already be calculated, and
+            // QuantLib must be built with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN since the instruments' rate helpers register with them
+            // and with QL_ENABLE_SESSIONS, where the evaluation date is per thread: each task sets it to the caller's evaluation date
+            template <
+                typename ImpliedValueCalculator
+            >
+            static Rate verifyImpl(
+                const Instruments& instruments,
+                const ImpliedValueCalculator& impliedValueCalculator,
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool = nullptr,
+                const QLUtils::ValuationContext& valuationContext = QLUtils::ValuationContext()  // global evaluation date of the calling thread if empty
+            ) {
+                Size n = 0;
+                for (const auto& pInst : instruments) {
+                    if (pInst != nullptr && pInst->use()) {
+                        ++n;
+                    }
+                }
+                auto& records = report.records;
+                records.resize(n);
+                Size j = 0;
+                for (const auto& pInst : instruments) {
+                    if (pInst != nullptr && pInst->use()) {
+                        auto& record = records[j++];
+                        record.instrument = pInst;
+                        record.actual = pInst->value();
+                    }
+                }
+                QLUtils::ValuationContext taskContext(valuationContext.evaluationDate());  // resolved on the calling thread
+                auto calculate = [&records, &impliedValueCalculator, &taskContext](std::size_t i) {
+                    QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(taskContext);  // no-op on the calling thread
+                    auto& record = records[i];
+                    record.implied = impliedValueCalculator(record.instrument);
+                };
+                if (pool != nullptr && pool->size() > 1 && n > 1) {
+                    pool->parallelFor(0, n, calculate);
+                }
+                else {
+                    for (Size i = 0; i < n; ++i) {
+                        calculate(i);
+                    }
+                }
+                Rate err = 0.0;
+                for (auto& record : records) {
+                    record.diff = record.implied - record.actual;
+                    record.error = record.diff * record.instrument->absoluteDiffMultiplier();
+                    err += record.error * record.error;
+                }
+                report.error = std::sqrt(err);
+                return report.error;
+            }
         };
 
         class IYieldCurvesBootstrap : public Bootstrapper {
@@ -79,6 +167,7 @@ namespace QuantLib {
             // input for the yield curve bootstrap
             pInstruments instruments; // bootstrap instruments
             YieldTermStructurePtr exogenousDiscountTermStructure;   // exogenous discount term structure. this can be nullptr (mode==BothCurvesConcurrently)
+            QLUtils::ValuationContext valuationContext; // as-of date for the bootstrap. if set, QuantLib's evaluation date is set to it while bootstrapping and the output curves are detached from the evaluation date (global evaluation date if empty)
         public:
             BootstrapMode bootstrapMode() const {
                 return (exogenousDiscountTermStructure != nullptr ? EstimatingCurveOnly : BothCurvesConcurrently);
@@ -99,26 +188,46 @@ namespace QuantLib {
                 std::ostream& os,
                 std::streamsize precision = 16
             ) const = 0;
+            virtual Rate verifyBootstrap(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool = nullptr
+            ) const = 0;
+            // detaches the output curves from the rate helpers and the evaluation date, e.g. before the evaluation date they were
+            // bootstrapped on is restored
+            virtual void freezeCurves() = 0;
         };
         typedef std::shared_ptr<IYieldCurvesBootstrap> YieldCurvesBootstrapPtr;
 
         template <
             typename Traits = ZeroYield,   // ZeroYield, Discount, ForwardRate, or SimpleZeroYield
-            typename Interpolator = Linear  // Linear, BackwardFlat, ConvexMonotone, or LogLinear
+            typename Interpolator = Linear,  // Linear, BackwardFlat, ConvexMonotone, or LogLinear
+            template<class> class Bootstrap = IterativeBootstrap   // IterativeBootstrap, or SuffixIterativeBootstrap to have rebootstrap() only re-solve the pillars after the first changed quote
         >
         class YieldCurvesBootstrap : public IYieldCurvesBootstrap {
         public:
-            typedef QLUtils::PiecewiseCurveBuilder<Traits, Interpolator> PiecewiseCurveBuilderType;
-            typedef PiecewiseYieldCurve<Traits, Interpolator> PiecewiseCurveType;
+            typedef QLUtils::PiecewiseCurveBuilder<Traits, Interpolator, Bootstrap> PiecewiseCurveBuilderType;
+            typedef typename PiecewiseCurveBuilderType::CurveType PiecewiseCurveType;
             typedef typename Traits::template curve<Interpolator>::type BaseCurveType;	// InterpolatedZeroCurve<Interpolator>, InterpolatedDiscountCurve<Interpolator>, InterpolatedForwardCurve<Interpolator>, or InterpolatedSimpleZeroCurve<Interpolator>
         protected:
             std::shared_ptr<PiecewiseCurveBuilderType> curveBuilder_;
+            // state of the last bootstrap kept for rebootstrap()
+            ext::shared_ptr<PiecewiseCurveType> piecewiseCurve_;
+            Instruments bootstrappedInstruments_;   // instruments behind curveBuilder_->helpers(), one for one
+            YieldTermStructurePtr bootstrappedDiscountTS_;
+            Date bootstrappedReferenceDate_;
+            DayCounter bootstrappedDayCounter_;
+            Interpolator bootstrappedInterp_;
+        public:
+            // input
+            bool collectDiagnostics;    // fill diagnostics on bootstrap() and rebootstrap()
+            std::shared_ptr<QLUtils::RateHelperCache> rateHelperCache;  // optional, re-uses the rate helpers of earlier bootstraps of the same instrument definitions
         public:
             // output
             ext::shared_ptr<BaseCurveType> discountCurve;   // this can be nullptr (mode==EstimatingCurveOnly)
             ext::shared_ptr<BaseCurveType> estimatingCurve; // as a valid bootstrap output, this is never null
+            QLUtils::BootstrapDiagnostics diagnostics;  // timings, solver evaluations, and residuals of the last (re)bootstrap, if collectDiagnostics is set
         public:
-            YieldCurvesBootstrap() {}
+            YieldCurvesBootstrap() : collectDiagnostics(false) {}
             YieldTermStructurePtr discounTermStructure() const override {
                 return (bootstrapMode() == EstimatingCurveOnly ? exogenousDiscountTermStructure : discountCurve); 
             }
@@ -129,14 +238,37 @@ namespace QuantLib {
             std::shared_ptr<PiecewiseCurveBuilderType>& curveBuilder() {
                 return curveBuilder_;
             }
+            // sets the outputs from the solved piecewise curve, while the evaluation date scope of the (re)bootstrap is still open
+            // with an explicit valuation context the outputs are frozen copies of the curve nodes: the piecewise curve's helpers re-date,
+            // and the curve re-bootstraps on its next use, as soon as the scope restores the global evaluation date
+            // piecewiseCurve_ itself is kept for the warm start of rebootstrap()
+            void setOutputs() {
+                estimatingCurve = (valuationContext.isExplicit() ? frozenCurve() : ext::shared_ptr<BaseCurveType>(piecewiseCurve_));
+                discountCurve = (bootstrapMode() == BothCurvesConcurrently ? estimatingCurve : nullptr);
+            }
+            ext::shared_ptr<BaseCurveType> frozenCurve() const {
+                ext::shared_ptr<BaseCurveType> frozen(new BaseCurveType(piecewiseCurve_->dates(), piecewiseCurve_->data(), bootstrappedDayCounter_, bootstrappedInterp_));
+                if (piecewiseCurve_->allowsExtrapolation()) {
+                    frozen->enableExtrapolation();
+                }
+                return frozen;
+            }
         public:
             const std::shared_ptr<PiecewiseCurveBuilderType>& curveBuilder() const {
                 return curveBuilder_;
             }
+            // interpolator used by the last bootstrap
+            const Interpolator& interpolator() const {
+                return bootstrappedInterp_;
+            }
             void clearOutputs() {
                 curveBuilder() = nullptr;
+                piecewiseCurve_ = nullptr;
+                bootstrappedInstruments_.clear();
+                bootstrappedDiscountTS_ = nullptr;
                 discountCurve = nullptr;
                 estimatingCurve = nullptr;
+                diagnostics.clear();
             }
             void bootstrap(
                 const Date& curveReferenceDate,
@@ -144,21 +276,87 @@ namespace QuantLib {
                 const Interpolator& interp = Interpolator()
             ) {
                 using DtFormat = QLUtils::DateFormat<char>;
+                typedef std::chrono::steady_clock Clock;
                 clearOutputs();
                 checkInstruments();
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
                 if (bootstrapMode() == EstimatingCurveOnly) {
                     auto expected = exogenousDiscountTermStructure->referenceDate();
                     QL_REQUIRE(curveReferenceDate == expected, "to be bootstrapped estimating curve ref. date (" << DtFormat::to_yyyymmdd(curveReferenceDate, true) << ") is not what's expected (discount curve ref. date=" << DtFormat::to_yyyymmdd(expected, true) << ")");
                 }
                 YieldTermStructureHandle hExogenousDiscountTS(exogenousDiscountTermStructure);
                 curveBuilder().reset(new PiecewiseCurveBuilderType()); // create the curve builder
+                auto start = Clock::now();
                 for (const auto& inst : *instruments) { // for each instrument
                     if (inst->use()) {
-                        this->curveBuilder_->AddHelper(inst->rateHelper(hExogenousDiscountTS));
+                        this->curveBuilder_->AddHelper(rateHelperCache != nullptr ? rateHelperCache->rateHelper(*inst, exogenousDiscountTermStructure) : inst->rateHelper(hExogenousDiscountTS));
+                        bootstrappedInstruments_.push_back(inst);
                     }
                 }
-                estimatingCurve = curveBuilder()->GetCurve(curveReferenceDate, dayCounter, interp);
-                discountCurve = (bootstrapMode() == BothCurvesConcurrently ? estimatingCurve : nullptr);
+                diagnostics.helperConstructionSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+                piecewiseCurve_ = curveBuilder()->GetCurve(curveReferenceDate, dayCounter, interp, (collectDiagnostics ? &diagnostics : nullptr));
+                bootstrappedDiscountTS_ = exogenousDiscountTermStructure;
+                bootstrappedReferenceDate_ = curveReferenceDate;
+                bootstrappedDayCounter_ = dayCounter;
+                bootstrappedInterp_ = interp;
+                setOutputs();
+            }
+            // re-bootstrap after the instrument values have changed (e.g. an intraday tick)
+            // the rate helpers and the curve of the last bootstrap() are kept alive, the current instrument values are pushed into the
+            // helpers' quotes, and the curve re-solves starting from its previous pillar values
+            // with Bootstrap = SuffixIterativeBootstrap and a local interpolator, only the pillars from the first changed quote onwards are re-solved
+            // falls back to a full bootstrap() with the last reference date, day counter, and interpolator if the set of used instruments
+            // or the exogenous discount term structure has changed, or if any helper cannot be updated in place
+            // returns true if the curve was re-solved in place, false if a full bootstrap was done
+            bool rebootstrap() {
+                QL_REQUIRE(piecewiseCurve_ != nullptr, "curve was never bootstrapped");
+                checkInstruments();
+                auto fullBootstrap = [this]() {
+                    auto curveReferenceDate = bootstrappedReferenceDate_;
+                    auto dayCounter = bootstrappedDayCounter_;
+                    auto interp = bootstrappedInterp_;
+                    this->bootstrap(curveReferenceDate, dayCounter, interp);
+                    return false;
+                };
+                if (exogenousDiscountTermStructure != bootstrappedDiscountTS_) {
+                    return fullBootstrap();
+                }
+                Size k = 0;
+                for (const auto& inst : *instruments) { // the used instruments must be the same ones, in the same order
+                    if (inst->use()) {
+                        if (k >= bootstrappedInstruments_.size() || inst != bootstrappedInstruments_[k]) {
+                            return fullBootstrap();
+                        }
+                        ++k;
+                    }
+                }
+                if (k != bootstrappedInstruments_.size()) {
+                    return fullBootstrap();
+                }
+                typedef std::chrono::steady_clock Clock;
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                YieldTermStructureHandle hExogenousDiscountTS(exogenousDiscountTermStructure);
+                const auto& helpers = curveBuilder()->helpers();
+                QL_ASSERT(helpers.size() == bootstrappedInstruments_.size(), "rate helpers and bootstrapped instruments are out of sync");
+                auto start = Clock::now();
+                for (Size i = 0; i < helpers.size(); ++i) {
+                    if (!bootstrappedInstruments_[i]->updateRateHelper(helpers[i], hExogenousDiscountTS)) {
+                        return fullBootstrap();
+                    }
+                }
+                diagnostics.clear();
+                diagnostics.helperConstructionSeconds = std::chrono::duration<double>(Clock::now() - start).count();   // updating the helpers' quotes
+                try {
+                    curveBuilder()->SolveCurve(piecewiseCurve_, (collectDiagnostics ? &diagnostics : nullptr));  // trigger the (warm-started) bootstrap
+                }
+                catch (...) {
+                    auto failedDiagnostics = diagnostics;
+                    clearOutputs();
+                    diagnostics = failedDiagnostics;    // keep the record of the failed solve
+                    throw;
+                }
+                setOutputs();
+                return true;
             }
             template<
                 typename ActualVsImpliedComparison = DefaultActualVsImpliedComparison
@@ -173,6 +371,7 @@ namespace QuantLib {
                 auto estimatingTS = this->estimatingTermStructure();
                 QL_REQUIRE(estimatingTS != nullptr, "forward estimating term structure cannot be null");
                 checkInstruments();
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
                 YieldTermStructureHandle hDiscountTS(discountTS);
                 YieldTermStructureHandle hEstimatingTS(estimatingTS);
                 return verifyImpl(
@@ -185,6 +384,31 @@ namespace QuantLib {
                     compare
                 );
             }
+            // allocation free verification into a report, optionally calculating the implied values on a thread pool
+            Rate verify(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool = nullptr
+            ) const {
+                auto discountTS = this->discounTermStructure();
+                QL_REQUIRE(discountTS != nullptr, "discount term structure cannot be null");
+                auto estimatingTS = this->estimatingTermStructure();
+                QL_REQUIRE(estimatingTS != nullptr, "forward estimating term structure cannot be null");
+                checkInstruments();
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                discountTS->discount(0);    // make sure both curves are calculated before any parallel access
+                estimatingTS->discount(0);
+                YieldTermStructureHandle hDiscountTS(discountTS);
+                YieldTermStructureHandle hEstimatingTS(estimatingTS);
+                return verifyImpl(
+                    *instruments,
+                    [&hDiscountTS, &hEstimatingTS](const pInstrument& pInst) -> Real {
+                        return pInst->impliedQuote(hEstimatingTS, hDiscountTS);
+                    },
+                    report,
+                    pool,
+                    valuationContext
+                );
+            }
             
             void piecewiseBootstrap(
                 const Date& curveReferenceDate,
@@ -199,6 +423,22 @@ namespace QuantLib {
             ) const override {
                 return this->verify<DefaultActualVsImpliedComparison>(os, precision);
             }
+            
+            Rate verifyBootstrap(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool
+            ) const override {
+                return this->verify(report, pool);
+            }
+            
+            // the outputs become frozen copies of the curve nodes, unless they already are (explicit valuation context)
+            // piecewiseCurve_ is kept for rebootstrap(), which sets the outputs again
+            void freezeCurves() override {
+                if (piecewiseCurve_ != nullptr && estimatingCurve == piecewiseCurve_) {
+                    estimatingCurve = frozenCurve();
+                    discountCurve = (bootstrapMode() == BothCurvesConcurrently ? estimatingCurve : nullptr);
+                }
+            }
         };
     }
 }
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/bootstrap.hpp>
+#include <vector>
+
+namespace QuantLib {
+    namespace Utils {
+        // sensitivities of a bootstrapped curve's pillar values to the quoted values of its bootstrap instruments
+        // at the bootstrap solution every used instrument reprices, implied_j(x) = value_j, where x are the curve's pillar values.
+        // by the implicit function theorem dx/dvalue = inverse(d implied/dx), so the full Jacobian comes from the solved curve by
+        // repricing the instruments on pillar-bumped copies of it, without any re-bootstrap
+        template <
+            typename Traits = ZeroYield,
+            typename Interpolator = Linear,
+            template<class> class Bootstrap = IterativeBootstrap
+        >
+        class YieldCurveJacobian {
+        public:
+            typedef YieldCurvesBootstrap<Traits, Interpolator, Bootstrap> YieldCurvesBootstrapType;
+            typedef typename YieldCurvesBootstrapType::BaseCurveType BaseCurveType;
+            typedef Bootstrapper::Instruments Instruments;
+            typedef Bootstrapper::YieldTermStructurePtr YieldTermStructurePtr;
+            typedef Bootstrapper::YieldTermStructureHandle YieldTermStructureHandle;
+        private:
+            std::vector<Real> pillarData_;  // solved curve data, pillar k is at index k + 1 (index 0 is the reference date node)
+            DayCounter dayCounter_;
+            Interpolator interp_;
+            YieldTermStructurePtr exogenousDiscountTermStructure_;
+            Real bumpSize_;
+        public:
+            // output
+            std::vector<Date> pillarDates;  // curve node dates, pillarDates[0] is the curve reference date
+            Instruments instruments;    // used instruments of the bootstrap, in input order
+            Matrix quoteJacobian;   // quoteJacobian[j][k] = d implied value of instruments[j] / d pillar k
+            Matrix pillarJacobian;  // pillarJacobian[k][j] = d pillar k / d value of instruments[j], the inverse of quoteJacobian
+        private:
+            YieldTermStructurePtr curve(const std::vector<Real>& data) const {
+                YieldTermStructurePtr ts(new BaseCurveType(pillarDates, data, dayCounter_, interp_));
+                ts->enableExtrapolation();  // instruments may reach slightly past the last pillar, as with the bootstrapped curve
+                return ts;
+            }
+            // curve data with pillar k bumped, in the bootstrap's own coordinates
+            std::vector<Real> bumpedData(Size k, Real bump) const {
+                auto data = pillarData_;
+                Traits::updateGuess(data, pillarData_[k + 1] + bump, k + 1);
+                return data;
+            }
+            template <typename F>
+            Real value(const std::vector<Real>& data, const F& f) const {
+                auto ts = curve(data);
+                YieldTermStructureHandle hEstimatingTS(ts);
+                YieldTermStructureHandle hDiscountTS(exogenousDiscountTermStructure_ != nullptr ? exogenousDiscountTermStructure_ : ts);
+                return f(hEstimatingTS, hDiscountTS);
+            }
+            Array impliedValues(const std::vector<Real>& data) const {
+                auto ts = curve(data);
+                YieldTermStructureHandle hEstimatingTS(ts);
+                YieldTermStructureHandle hDiscountTS(exogenousDiscountTermStructure_ != nullptr ? exogenousDiscountTermStructure_ : ts);
+                Array ret(instruments.size());
+                for (Size j = 0; j < instruments.size(); ++j) {
+                    ret[j] = instruments[j]->impliedQuote(hEstimatingTS, hDiscountTS);
+                }
+                return ret;
+            }
+        public:
+            YieldCurveJacobian() : bumpSize_(1.0e-6) {}
+            Size numPillars() const {
+                return (pillarDates.empty() ? 0 : pillarDates.size() - 1);
+            }
+            // calculate the Jacobians of a bootstrapped curve using central differences of size bumpSize in the pillar values
+            void calculate(
+                const YieldCurvesBootstrapType& bootstrap,
+                Real bumpSize = 1.0e-6
+            ) {
+                QL_REQUIRE(bumpSize > 0.0, "bump size (" << bumpSize << ") must be positive");
+                QL_REQUIRE(bootstrap.estimatingCurve != nullptr, "curve is not bootstrapped");
+                QL_REQUIRE(bootstrap.instruments != nullptr, "instruments is not set");
+                const auto& solvedCurve = bootstrap.estimatingCurve;
+                solvedCurve->discount(0);   // make sure the curve is up to date
+                pillarDates = solvedCurve->dates();
+                pillarData_ = solvedCurve->data();
+                dayCounter_ = solvedCurve->dayCounter();
+                interp_ = bootstrap.interpolator();
+                exogenousDiscountTermStructure_ = (bootstrap.bootstrapMode() == IYieldCurvesBootstrap::EstimatingCurveOnly ? bootstrap.exogenousDiscountTermStructure : nullptr);
+                bumpSize_ = bumpSize;
+                instruments.clear();
+                for (const auto& inst : *bootstrap.instruments) {
+                    if (inst->use()) {
+                        instruments.push_back(inst);
+                    }
+                }
+                auto n = numPillars();
+                QL_REQUIRE(instruments.size() == n, "number of used instruments (" << instruments.size() << ") is not the same as the number of curve pillars (" << n << "), expired instruments are not supported");
+                quoteJacobian = Matrix(n, n);
+                for (Size k = 0; k < n; ++k) {  // for each pillar
+                    auto up = impliedValues(bumpedData(k, bumpSize));
+                    auto down = impliedValues(bumpedData(k, -bumpSize));
+                    for (Size j = 0; j < n; ++j) {
+                        quoteJacobian[j][k] = (up[j] - down[j]) / (2.0 * bumpSize);
+                    }
+                }
+                pillarJacobian = inverse(quoteJacobian);
+            }
+            // sensitivities of a value to the curve pillars, f(estimatingTermStructure, discountingTermStructure) -> Real
+            template <typename F>
+            Array pillarSensitivities(const F& f) const {
+                auto n = numPillars();
+                QL_REQUIRE(n > 0, "Jacobian is not calculated");
+                Array ret(n);
+                for (Size k = 0; k < n; ++k) {
+                    auto up = value(bumpedData(k, bumpSize_), f);
+                    auto down = value(bumpedData(k, -bumpSize_), f);
+                    ret[k] = (up - down) / (2.0 * bumpSize_);
+                }
+                return ret;
+            }
+            // par-point risk: maps sensitivities to the curve pillars to sensitivities to the instruments' quoted values (per unit of value)
+            // ret[j] = sum over k of pillarSensitivities[k] * d pillar k / d value of instruments[j]
+            Array parPointRisk(const Array& pillarSensitivities) const {
+                QL_REQUIRE(pillarSensitivities.size() == pillarJacobian.rows(), "number of pillar sensitivities (" << pillarSensitivities.size() << ") is not the same as the number of curve pillars (" << pillarJacobian.rows() << ")");
+                return transpose(pillarJacobian) * pillarSensitivities;
+            }
+            template <typename F>
+            Array parPointRisk(const F& f) const {
+                return parPointRisk(pillarSensitivities(f));
+            }
+        };
+    }
+}
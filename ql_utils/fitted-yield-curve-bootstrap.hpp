@@ -0,0 +1,364 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/bootstrap.hpp>
+#include <ql_utils/termstructures/yield/bootstraptraits.hpp>
+#include <ql_utils/utilities/thread-pool.hpp>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+namespace QuantLib {
+    namespace Utils {
+        // curve data values (in the traits' own coordinates) read off an existing term structure, used as the initial guess of a fit
+        template <typename Traits>
+        struct FittedCurveCoordinates;
+        template <>
+        struct FittedCurveCoordinates<ZeroYield> {
+            static Real value(const YieldTermStructure& ts, Time t) {
+                return ts.zeroRate(t, Continuous, NoFrequency, true).rate();
+            }
+        };
+        template <>
+        struct FittedCurveCoordinates<Discount> {
+            static Real value(const YieldTermStructure& ts, Time t) {
+                return ts.discount(t, true);
+            }
+        };
+        template <>
+        struct FittedCurveCoordinates<ForwardRate> {
+            static Real value(const YieldTermStructure& ts, Time t) {
+                return ts.forwardRate(t, t, Continuous, NoFrequency, true).rate();
+            }
+        };
+        template <>
+        struct FittedCurveCoordinates<SimpleZeroYield> {
+            static Real value(const YieldTermStructure& ts, Time t) {
+                return ts.zeroRate(t, Simple, Annual, true).rate();
+            }
+        };
+        template <>
+        struct FittedCurveCoordinates<BugFix::SimpleZeroYield> {
+            static Real value(const YieldTermStructure& ts, Time t) {
+                return ts.zeroRate(t, Simple, Annual, true).rate();
+            }
+        };
+
+        // least-squares fit of an interpolated curve to the bootstrap instruments, as an alternative to the exact piecewise bootstrap
+        // the curve values at a set of knots are chosen by Levenberg-Marquardt to minimize sum of weight * ((implied - actual) * absoluteDiffMultiplier)^2
+        // over the used instruments. unlike the piecewise bootstrap it does not require one instrument per pillar, so it also works for
+        // overdetermined sets (e.g. hundreds of treasury CUSIPs) where an exact fit fails or produces jagged forwards
+        // the instruments' implied quotes are black boxes, so the Jacobian is calculated by forward differences in the knot values,
+        // one knot per task on a thread pool, and the residuals of a curve are calculated in parallel as well. with numThreads != 1
+        // QuantLib must therefore be built with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN
+        template <
+            typename Traits = ZeroYield,   // ZeroYield, Discount, ForwardRate, or SimpleZeroYield
+            typename Interpolator = Linear  // Linear, BackwardFlat, ConvexMonotone, LogLinear, or a spline
+        >
+        class FittedYieldCurveBootstrap : public IYieldCurvesBootstrap {
+        public:
+            typedef typename Traits::template curve<Interpolator>::type BaseCurveType;
+            typedef std::function<Real(const Instrument&)> WeightFunction;
+        private:
+            class CurveCostFunction : public CostFunction {
+            private:
+                const FittedYieldCurveBootstrap& fit_;
+            public:
+                explicit CurveCostFunction(const FittedYieldCurveBootstrap& fit) : fit_(fit) {}
+                Array values(const Array& x) const override {
+                    return fit_.calculateResiduals(x);
+                }
+                Real value(const Array& x) const override {
+                    auto r = values(x);
+                    return std::sqrt(DotProduct(r, r) / r.size());
+                }
+                void jacobian(Matrix& jac, const Array& x) const override {
+                    fit_.residualJacobian(jac, x);
+                }
+            };
+        public:
+            // input
+            std::vector<Period> knotTenors; // knots from the curve reference date. knots with no instrument maturing since the previous knot are dropped, and the last knot is moved to the last maturity
+            WeightFunction weight;  // weight of an instrument's squared residual (1 for all if not set)
+            YieldTermStructurePtr initialCurve; // initial guess (flat detail::avgRate if not set)
+            Size numThreads;    // 0 => one per hardware thread, 1 => no parallelism
+            Size maxIterations;
+            Real accuracy;  // tolerance on the residuals, the knot values, and the gradient
+            Real bumpSize;  // knot bump for the finite difference Jacobian
+        private:
+            Instruments fitInstruments_;    // used instruments
+            std::vector<Real> weights_; // sqrt of the instrument weights
+            std::vector<Date> dates_;   // curve nodes, dates_[0] is the reference date
+            DayCounter dayCounter_;
+            Interpolator interp_;
+            std::unique_ptr<QLUtils::ThreadPool> pool_;
+            QLUtils::ValuationContext taskContext_; // evaluation date of the fit, resolved on the calling thread for the pool tasks
+        public:
+            // output
+            ext::shared_ptr<BaseCurveType> discountCurve;   // this can be nullptr (mode==EstimatingCurveOnly)
+            ext::shared_ptr<BaseCurveType> estimatingCurve;
+            std::vector<Date> knotDates;    // curve nodes, knotDates[0] is the curve reference date
+            Array residuals;    // weighted residuals of the used instruments at the solution, in input order
+            Real rmsError;  // sqrt(mean(residuals^2))
+            EndCriteria::Type endCriteria;
+            Integer functionEvaluations;
+        public:
+            FittedYieldCurveBootstrap() :
+                knotTenors({3 * Months, 6 * Months, 1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years, 15 * Years, 20 * Years, 30 * Years}),
+                numThreads(0),
+                maxIterations(1000),
+                accuracy(1.0e-10),
+                bumpSize(1.0e-6),
+                rmsError(Null<Real>()),
+                endCriteria(EndCriteria::None),
+                functionEvaluations(0)
+            {}
+            YieldTermStructurePtr discounTermStructure() const override {
+                return (bootstrapMode() == EstimatingCurveOnly ? exogenousDiscountTermStructure : discountCurve);
+            }
+            YieldTermStructurePtr estimatingTermStructure() const override {
+                return estimatingCurve;
+            }
+            void clearOutputs() {
+                discountCurve = nullptr;
+                estimatingCurve = nullptr;
+                knotDates.clear();
+                residuals = Array();
+                rmsError = Null<Real>();
+                endCriteria = EndCriteria::None;
+                functionEvaluations = 0;
+            }
+        private:
+            ext::shared_ptr<BaseCurveType> curve(const Array& x) const {
+                std::vector<Real> data(dates_.size(), Traits::initialValue(nullptr));
+                for (Size k = 0; k < x.size(); ++k) {
+                    Traits::updateGuess(data, x[k], k + 1);
+                }
+                ext::shared_ptr<BaseCurveType> ts(new BaseCurveType(dates_, data, dayCounter_, interp_));
+                ts->enableExtrapolation();  // instruments may mature slightly past the last knot
+                return ts;
+            }
+            // residuals of instruments [begin, end) on the given curve
+            void calculateResiduals(
+                const ext::shared_ptr<BaseCurveType>& ts,
+                Size begin,
+                Size end,
+                Array& r
+            ) const {
+                YieldTermStructureHandle hEstimatingTS(ts);
+                YieldTermStructureHandle hDiscountTS(bootstrapMode() == EstimatingCurveOnly ? exogenousDiscountTermStructure : YieldTermStructurePtr(ts));
+                for (Size j = begin; j < end; ++j) {
+                    const auto& inst = fitInstruments_[j];
+                    auto implied = inst->impliedQuote(hEstimatingTS, hDiscountTS);
+                    r[j] = weights_[j] * (implied - inst->value()) * inst->absoluteDiffMultiplier();
+                }
+            }
+            Array calculateResiduals(const Array& x) const {
+                auto ts = curve(x);
+                auto n = fitInstruments_.size();
+                Array r(n);
+                if (pool_ != nullptr) {
+                    pool_->parallelFor(0, n, [&](std::size_t j) {
+                        QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(taskContext_);
+                        calculateResiduals(ts, j, j + 1, r);
+                    });
+                }
+                else {
+                    calculateResiduals(ts, 0, n, r);
+                }
+                return r;
+            }
+            void residualJacobian(Matrix& jac, const Array& x) const {
+                auto n = fitInstruments_.size();
+                auto base = calculateResiduals(x);
+                jac = Matrix(n, x.size());
+                auto column = [&](std::size_t k) {
+                    QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(taskContext_);  // no-op on the calling thread
+                    auto bumped = x;
+                    bumped[k] += bumpSize;
+                    Array r(n);
+                    calculateResiduals(curve(bumped), 0, n, r);
+                    for (Size j = 0; j < n; ++j) {
+                        jac[j][k] = (r[j] - base[j]) / bumpSize;
+                    }
+                };
+                if (pool_ != nullptr) {
+                    pool_->parallelFor(0, x.size(), column);
+                }
+                else {
+                    for (Size k = 0; k < x.size(); ++k) {
+                        column(k);
+                    }
+                }
+            }
+            void setupKnots(const Date& curveReferenceDate) {
+                QL_REQUIRE(!knotTenors.empty(), "knot tenors cannot be empty");
+                std::vector<Date> maturities;
+                for (const auto& inst : fitInstruments_) {
+                    maturities.push_back(inst->maturityDate());
+                }
+                std::sort(maturities.begin(), maturities.end());
+                QL_REQUIRE(maturities.front() > curveReferenceDate, "instruments cannot mature on or before the curve reference date (" << curveReferenceDate << ")");
+                auto tenors = knotTenors;
+                std::sort(tenors.begin(), tenors.end());
+                dates_.assign(1, curveReferenceDate);
+                auto m = maturities.begin();
+                for (const auto& tenor : tenors) {
+                    auto d = std::min(curveReferenceDate + tenor, maturities.back());
+                    if (d <= dates_.back()) {
+                        continue;
+                    }
+                    auto next = std::upper_bound(m, maturities.end(), d);
+                    if (next != m) {    // at least one instrument matures in (previous knot, d]
+                        dates_.push_back(d);
+                        m = next;
+                    }
+                    if (d == maturities.back()) {
+                        break;
+                    }
+                }
+                if (dates_.back() < maturities.back()) {  // last knot at the last maturity
+                    dates_.push_back(maturities.back());
+                }
+                QL_REQUIRE(dates_.size() - 1 <= fitInstruments_.size(), "number of knots (" << dates_.size() - 1 << ") cannot exceed the number of used instruments (" << fitInstruments_.size() << ")");
+                QL_REQUIRE(dates_.size() >= Interpolator::requiredPoints, "not enough knots: " << dates_.size() - 1 << " provided, " << Interpolator::requiredPoints - 1 << " required");
+            }
+        public:
+            void fit(
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter = Actual365Fixed(),
+                const Interpolator& interp = Interpolator()
+            ) {
+                clearOutputs();
+                checkInstruments();
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                if (bootstrapMode() == EstimatingCurveOnly) {
+                    auto expected = exogenousDiscountTermStructure->referenceDate();
+                    QL_REQUIRE(curveReferenceDate == expected, "to be fitted estimating curve ref. date (" << curveReferenceDate << ") is not what's expected (discount curve ref. date=" << expected << ")");
+                    exogenousDiscountTermStructure->discount(0);    // make sure it is calculated before any parallel access
+                }
+                QL_REQUIRE(bumpSize > 0.0, "bump size (" << bumpSize << ") must be positive");
+                fitInstruments_.clear();
+                weights_.clear();
+                for (const auto& inst : *instruments) {
+                    if (inst->use()) {
+                        inst->ensureValueIsSet();
+                        auto w = (weight != nullptr ? weight(*inst) : 1.0);
+                        QL_REQUIRE(w >= 0.0, "weight (" << w << ") of instrument " << inst->ticker() << " cannot be negative");
+                        fitInstruments_.push_back(inst);
+                        weights_.push_back(std::sqrt(w));
+                    }
+                }
+                dayCounter_ = dayCounter;
+                interp_ = interp;
+                setupKnots(curveReferenceDate);
+                YieldTermStructurePtr guessCurve = initialCurve;
+                if (guessCurve == nullptr) {
+                    guessCurve.reset(new FlatForward(curveReferenceDate, detail::avgRate, dayCounter_));
+                }
+                Array x(dates_.size() - 1);
+                for (Size k = 0; k < x.size(); ++k) {
+                    x[k] = FittedCurveCoordinates<Traits>::value(*guessCurve, dayCounter_.yearFraction(curveReferenceDate, dates_[k + 1]));
+                }
+                auto threads = (numThreads == 0 ? QLUtils::ThreadPool::defaultConcurrency() : numThreads);
+                taskContext_ = QLUtils::ValuationContext(valuationContext.evaluationDate());
+                pool_.reset(threads > 1 ? new QLUtils::ThreadPool(threads) : nullptr);
+                CurveCostFunction costFunction(*this);
+                NoConstraint constraint;
+                Problem problem(costFunction, constraint, x);
+                LevenbergMarquardt solver(accuracy, accuracy, accuracy, true);  // use the parallel Jacobian of the cost function
+                EndCriteria criteria(maxIterations, std::min<Size>(maxIterations, 100), accuracy, accuracy, accuracy);
+                try {
+                    endCriteria = solver.minimize(problem, criteria);
+                }
+                catch (...) {
+                    pool_.reset();
+                    throw;
+                }
+                pool_.reset();
+                QL_REQUIRE(EndCriteria::succeeded(endCriteria), "curve fit failed, end criteria=" << endCriteria);
+                functionEvaluations = problem.functionEvaluation();
+                estimatingCurve = curve(problem.currentValue());
+                discountCurve = (bootstrapMode() == BothCurvesConcurrently ? estimatingCurve : nullptr);
+                knotDates = dates_;
+                residuals = calculateResiduals(problem.currentValue());
+                rmsError = std::sqrt(DotProduct(residuals, residuals) / residuals.size());
+            }
+            template<
+                typename ActualVsImpliedComparison = DefaultActualVsImpliedComparison
+            >
+            Rate verify(
+                std::ostream& os,
+                std::streamsize precision = 16,
+                const ActualVsImpliedComparison& compare = ActualVsImpliedComparison()
+            ) const {
+                auto discountTS = this->discounTermStructure();
+                QL_REQUIRE(discountTS != nullptr, "discount term structure cannot be null");
+                auto estimatingTS = this->estimatingTermStructure();
+                QL_REQUIRE(estimatingTS != nullptr, "forward estimating term structure cannot be null");
+                checkInstruments();
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                YieldTermStructureHandle hDiscountTS(discountTS);
+                YieldTermStructureHandle hEstimatingTS(estimatingTS);
+                return verifyImpl(
+                    *instruments,
+                    [&hDiscountTS, &hEstimatingTS](const pInstrument& pInst) -> Real {
+                        return pInst->impliedQuote(hEstimatingTS, hDiscountTS);
+                    },
+                    os,
+                    precision,
+                    compare
+                );
+            }
+            Rate verify(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool = nullptr
+            ) const {
+                auto discountTS = this->discounTermStructure();
+                QL_REQUIRE(discountTS != nullptr, "discount term structure cannot be null");
+                auto estimatingTS = this->estimatingTermStructure();
+                QL_REQUIRE(estimatingTS != nullptr, "forward estimating term structure cannot be null");
+                checkInstruments();
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                discountTS->discount(0);
+                YieldTermStructureHandle hDiscountTS(discountTS);
+                YieldTermStructureHandle hEstimatingTS(estimatingTS);
+                return verifyImpl(
+                    *instruments,
+                    [&hDiscountTS, &hEstimatingTS](const pInstrument& pInst) -> Real {
+                        return pInst->impliedQuote(hEstimatingTS, hDiscountTS);
+                    },
+                    report,
+                    pool,
+                    valuationContext
+                );
+            }
+
+            void piecewiseBootstrap(
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter
+            ) override {
+                this->fit(curveReferenceDate, dayCounter);
+            }
+
+            Rate verifyBootstrap(
+                std::ostream& os,
+                std::streamsize precision
+            ) const override {
+                return this->verify<DefaultActualVsImpliedComparison>(os, precision);
+            }
+
+            Rate verifyBootstrap(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool
+            ) const override {
+                return this->verify(report, pool);
+            }
+
+            // the fitted outputs are already plain interpolated curves of the fitted nodes
+            void freezeCurves() override {}
+        };
+    }
+}
@@ -39,10 +39,10 @@ namespace QuantLib {
             ) {
                 this->datedDate() = maturityDate;
             }
-            // given today's date/valuation date, find the number of settlement days that would yield the expected settlement date for this bond
+            // given today's date/valuation date (from the valuation context), find the number of settlement days that would yield the expected settlement date for this bond
             Natural getMatchingSettlementDays() const {
                 auto targetSettlementDate = settlementDate();
-                auto today = Settings::instance().evaluationDate();
+                auto today = this->valuationContext().evaluationDate();
                 QL_ASSERT(today != Date(), "evaluation date/today not set");
                 QL_REQUIRE(today <= targetSettlementDate, "evaluation date/today is after the target settlement date");
                 auto n = settlementDays();
@@ -266,7 +266,8 @@ namespace QuantLib {
                 Period tenor,                       // bond's claimed original tenor
                 Date maturityDate = Date(),         // bond's maturity date, if not given, it will be calculated based on the settlement date and the tenor
                 Rate coupon = 0.,                   // bond's fixed coupon rate
-                Date settlementDate = Date()        // settlement date for calculating accrued interest, prices, and yield to maturity
+                Date settlementDate = Date(),       // settlement date for calculating accrued interest, prices, and yield to maturity
+                const QLUtils::ValuationContext& valuationContext = {}  // provides today
             ) :
                 QLUtils::BootstrapInstrument(QLUtils::BootstrapInstrument::vtPrice, tenor, maturityDate),
                 coupon_(coupon),
@@ -278,8 +279,9 @@ namespace QuantLib {
                 shortCouponYearFraction_(0.)
             {
                 QL_REQUIRE(tenor.length() > 0, "The length of the bond tenor (" << tenor.length() << ") must be greater than 0");
+                this->valuationContext() = valuationContext;
                 if (settlementDate_ == Date()) {    // bond settlement date is not given => calculate the settlement date based on the evaluation date and settlement days
-                    Date today = Settings::instance().evaluationDate();
+                    Date today = valuationContext.evaluationDate();
                     QL_REQUIRE(today != Date(), "evaluation date/today not set");
                     FixingDateAdjustment fixingAdj(settlementDays(), settlementCalendar());
                     auto ret = fixingAdj.calculate(today);
@@ -726,8 +728,9 @@ namespace QuantLib {
             ZeroCouponBill(
                 Period tenor,                   // bond's claimed original tenor
                 Date maturityDate,              // maturity date of the bond
-                Date settlementDate = Date()    // settlement date for calculating accrued interest, prices, and yield to maturity
-            ) : FixedCoupondBond<typename BillTraits::BondTraits>(tenor, maturityDate, 0., settlementDate),
+                Date settlementDate = Date(),   // settlement date for calculating accrued interest, prices, and yield to maturity
+                const QLUtils::ValuationContext& valuationContext = {}  // provides today
+            ) : FixedCoupondBond<typename BillTraits::BondTraits>(tenor, maturityDate, 0., settlementDate, valuationContext),
                 discountRateDayCounter_(billTraits_.discountRateDayCounter(tenor))
             {
                 auto settleDate = this->settlementDate();
@@ -919,8 +922,9 @@ namespace QuantLib {
             TheoreticalBond(
                 Period tenor,                   // tenor of the bond
                 Rate coupon = 0.,               // coupon of the bond
-                Date settlementDate = Date()    // settlement date for calculating accrued interest, prices, and yield to maturity
-            ) :FixedCoupondBond<BondTraits>(tenor, Date(), coupon, settlementDate) {
+                Date settlementDate = Date(),   // settlement date for calculating accrued interest, prices, and yield to maturity
+                const QLUtils::ValuationContext& valuationContext = {}  // provides today
+            ) :FixedCoupondBond<BondTraits>(tenor, Date(), coupon, settlementDate, valuationContext) {
                 this->cleanPrice() = this->parNotional();   // default the clean price of the bond to par by assuming the coupon variable is a par coupon
             }
             std::string instrumentTypeAlias() const override {
@@ -939,8 +943,9 @@ namespace QuantLib {
                 Period tenor,                   // bond's claimed original tenor
                 Date maturityDate,              // maturity date of the bond
                 Rate parCoupon,                 // par coupon of the bond
-                Date settlementDate = Date()    // settlement date for calculating accrued interest, prices, and yield to maturity
-            ) :FixedCoupondBond<BondTraits>(tenor, maturityDate, parCoupon, settlementDate) {
+                Date settlementDate = Date(),   // settlement date for calculating accrued interest, prices, and yield to maturity
+                const QLUtils::ValuationContext& valuationContext = {}  // provides today
+            ) :FixedCoupondBond<BondTraits>(tenor, maturityDate, parCoupon, settlementDate, valuationContext) {
                 this->cleanPrice() = this->parNotional();   // set the clean price of the bond to par because the coupon is a par coupon
             }
             std::string instrumentTypeAlias() const override {
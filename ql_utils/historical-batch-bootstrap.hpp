@@ -0,0 +1,181 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/bootstrap.hpp>
+#include <ql_utils/utilities/thread-pool.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+namespace QuantLib {
+    namespace Utils {
+        // detaches the curves of a market date from the evaluation date, while it is still set to the market date
+        // the results are handled after the evaluation date is restored, when the rate helpers of live (piecewise) curves would
+        // re-date them and the curves would re-bootstrap on their next use
+        // specialize for curve result types other than bootstraps and vectors of them
+        template <typename CurveResult>
+        struct HistoricalCurveFreezer {
+            static_assert(sizeof(CurveResult) == 0, "HistoricalCurveFreezer is not specialized for this curve result type");
+            static void freeze(CurveResult&) {}
+        };
+        template <>
+        struct HistoricalCurveFreezer<YieldCurvesBootstrapPtr> {
+            static void freeze(YieldCurvesBootstrapPtr& bootstrap) {
+                if (bootstrap != nullptr) {
+                    bootstrap->freezeCurves();
+                }
+            }
+        };
+        template <typename CurveResult>
+        struct HistoricalCurveFreezer<std::vector<CurveResult>> {
+            static void freeze(std::vector<CurveResult>& curves) {
+                for (auto& c : curves) {
+                    HistoricalCurveFreezer<CurveResult>::freeze(c);
+                }
+            }
+        };
+
+        // bootstraps the curves of many historical market dates, with results streamed back in date order
+        // each date's curves are built and bootstrapped by a user function that runs with Settings::instance().evaluationDate()
+        // set to the market date, since the instruments (IMMFuture, swap indexes, par bonds, ...) read the evaluation date
+        // when they are constructed. the curves are frozen (see HistoricalCurveFreezer) before the evaluation date is restored
+        // the dates can only be bootstrapped in parallel if every worker thread has its own Settings, i.e. QuantLib is built with
+        // QL_ENABLE_SESSIONS (with a sessionId() returning a per thread id) and QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN. otherwise
+        // the dates are bootstrapped one at a time on the calling thread
+        template <
+            typename CurveResult = YieldCurvesBootstrapPtr  // whatever the date function produces, e.g. a bootstrap or a set of bootstraps
+        >
+        class HistoricalBatchBootstrap {
+        public:
+            typedef std::function<CurveResult(const Date&)> DateBootstrap; // builds and bootstraps the curve(s) of one market date
+            struct DateResult {
+                Date date;
+                CurveResult curves;
+                bool succeeded;
+                std::string error;
+                double elapsedSeconds;
+                DateResult() : succeeded(false), elapsedSeconds(0.0) {}
+            };
+            typedef std::function<void(DateResult&)> ResultHandler;   // receives the results in date order, on the calling thread
+        public:
+            // input
+            Size numThreads;    // 0 => one per hardware thread. ignored (1 thread) without QL_ENABLE_SESSIONS
+            Size windowSize;    // max number of dates bootstrapped or waiting to be handled at any time (0 => 4 per thread). bounds memory use
+        public:
+            HistoricalBatchBootstrap(
+                Size numThreads = 0,
+                Size windowSize = 0
+            ) : numThreads(numThreads), windowSize(windowSize) {}
+            static bool parallelCapable() {
+#ifdef QL_ENABLE_SESSIONS
+                return true;
+#else
+                return false;
+#endif
+            }
+            Size actualNumThreads() const {
+                if (!parallelCapable()) {
+                    return 1;
+                }
+                return (numThreads == 0 ? QLUtils::ThreadPool::defaultConcurrency() : numThreads);
+            }
+        private:
+            static DateResult bootstrapDate(
+                const Date& date,
+                const DateBootstrap& dateBootstrap
+            ) {
+                typedef std::chrono::steady_clock Clock;
+                auto start = Clock::now();
+                DateResult result;
+                result.date = date;
+                try {
+                    SavedSettings backup;   // restores this thread's evaluation date when done
+                    Settings::instance().evaluationDate() = date;
+                    result.curves = dateBootstrap(date);
+                    HistoricalCurveFreezer<CurveResult>::freeze(result.curves);
+                    result.succeeded = true;
+                }
+                catch (const std::exception& e) {
+                    result.error = e.what();
+                }
+                catch (...) {
+                    result.error = "unknown error";
+                }
+                result.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+                return result;
+            }
+        public:
+            // dates must be strictly increasing. a failed date does not stop the run, its result carries the error
+            void run(
+                const std::vector<Date>& dates,
+                const DateBootstrap& dateBootstrap,
+                const ResultHandler& handler
+            ) const {
+                QL_REQUIRE(dateBootstrap != nullptr, "date bootstrap function is not set");
+                QL_REQUIRE(handler != nullptr, "result handler is not set");
+                for (Size i = 1; i < dates.size(); ++i) {
+                    QL_REQUIRE(dates[i - 1] < dates[i], "market dates must be strictly increasing (" << dates[i - 1] << ", " << dates[i] << ")");
+                }
+                auto threads = std::min<Size>(actualNumThreads(), std::max<Size>(1, dates.size()));
+                if (threads == 1) {
+                    for (const auto& date : dates) {
+                        auto result = bootstrapDate(date, dateBootstrap);
+                        handler(result);
+                    }
+                    return;
+                }
+                auto window = (windowSize == 0 ? 4 * threads : std::max<Size>(windowSize, threads));
+                std::mutex mutex;
+                std::condition_variable resultReady;
+                std::map<Size, DateResult> completed;   // reorder buffer, keyed by date index
+                QLUtils::ThreadPool pool(threads);  // declared last so that its workers are joined before the buffer goes away
+                Size submitted = 0;
+                auto submitNext = [&]() {
+                    auto i = submitted++;
+                    pool.submit([&, i]() {
+                        auto result = bootstrapDate(dates[i], dateBootstrap);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        completed[i] = std::move(result);
+                        resultReady.notify_one();
+                    });
+                };
+                while (submitted < std::min(window, dates.size())) {
+                    submitNext();
+                }
+                for (Size next = 0; next < dates.size(); ++next) {
+                    DateResult result;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        resultReady.wait(lock, [&completed, next]() {return completed.count(next) > 0;});
+                        auto p = completed.find(next);
+                        result = std::move(p->second);
+                        completed.erase(p);
+                    }
+                    if (submitted < dates.size()) {
+                        submitNext();
+                    }
+                    handler(result);
+                }
+            }
+            // convenience overload collecting all the results in date order
+            std::vector<DateResult> run(
+                const std::vector<Date>& dates,
+                const DateBootstrap& dateBootstrap
+            ) const {
+                std::vector<DateResult> results;
+                results.reserve(dates.size());
+                run(dates, dateBootstrap, [&results](DateResult& result) {
+                    results.push_back(std::move(result));
+                });
+                return results;
+            }
+        };
+    }
+}
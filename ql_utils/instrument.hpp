@@ -1,12 +1,15 @@
 #pragma once
 
 #include <string>
+#include <sstream>
+#include <typeinfo>
 #include <algorithm>
 #include <cmath>
 #include <ql/quantlib.hpp>
 #include <ql_utils/types.hpp>
 #include <ql_utils/fixing-date-adjustment.hpp>
 #include <ql_utils/swap-index-traits.hpp>
+#include <ql_utils/valuation-context.hpp>
 #include <ql_utils/ratehelpers/nominal_forward_ratehelper.hpp>
 
 namespace QLUtils {
@@ -27,6 +30,7 @@ namespace QLUtils {
         ValueType valueType_;
         QuantLib::Real value_;
         bool use_;
+        ValuationContext valuationContext_; // as-of date the instrument is set up for (global evaluation date if empty)
     public:
         BootstrapInstrument(
             const ValueType& valueType,
@@ -75,6 +79,12 @@ namespace QLUtils {
         bool& use() {
             return use_;
         }
+        const ValuationContext& valuationContext() const {
+            return valuationContext_;
+        }
+        ValuationContext& valuationContext() {
+            return valuationContext_;
+        }
         const QuantLib::Rate& rate() const {
             return value_;
         }
@@ -209,6 +219,43 @@ namespace QLUtils {
             auto compounding = df_start / df_end;
             return (compounding - 1.) / t;  // compounding = 1 + forwardRate * t
         }
+        // in-place update of rate helpers for re-bootstrapping
+        ////////////////////////////////////////////////////////////////////////////////
+        // identifies everything the rate helper created by rateHelper() depends on except the quoted value and the evaluation date, used as
+        // the key for caching rate helpers. RateHelperCache keeps the evaluation date with the helper, so that the helpers that re-date
+        // themselves (QuantLib::RelativeDateRateHelper) are re-used from one day to the next
+        // derived classes with definition fields that are not reflected in the type, ticker, tenor, and dated date must extend it
+        virtual std::string definitionKey() const {
+            std::ostringstream oss;
+            oss << typeid(*this).name();
+            oss << "|" << ticker_;
+            oss << "|" << tenor_;
+            oss << "|" << datedDate_.serialNumber();
+            oss << "|" << valueType_;
+            return oss.str();
+        }
+        // the value carried by the quote of the rate helper created by rateHelper()
+        virtual QuantLib::Real rateHelperQuoteValue(
+            const YieldTermStructureHandle& discountingTermStructure = {}
+        ) const {
+            ensureValueIsSet();
+            return value();
+        }
+        // push the current quoted value into a rate helper previously created by rateHelper() with the same discounting term structure
+        // returns false if the helper cannot be updated in place and has to be re-created
+        virtual bool updateRateHelper(
+            const pRateHelper& helper,
+            const YieldTermStructureHandle& discountingTermStructure = {}
+        ) const {
+            QL_REQUIRE(helper != nullptr, "rate helper cannot be null");
+            auto q = QuantLib::ext::dynamic_pointer_cast<QuantLib::SimpleQuote>(helper->quote().currentLink());
+            if (q == nullptr) {
+                return false;
+            }
+            q->setValue(rateHelperQuoteValue(discountingTermStructure));   // only notifies the helper's observers if the value has changed
+            return true;
+        }
+        ////////////////////////////////////////////////////////////////////////////////
         // virtual methods that must be implemented by derived classes for bootstrapping
         ////////////////////////////////////////////////////////////////////////////////
         virtual QuantLib::Date startDate() const = 0;
@@ -263,6 +310,12 @@ namespace QLUtils {
             QL_ASSERT(helper != nullptr, "Fixed rate bond helper is null");
             return helper;
         };
+        bool updateRateHelper(
+            const pRateHelper& helper,
+            const YieldTermStructureHandle& discountingTermStructure = {}
+        ) const override {  // BootstrapInstrument
+            return false;   // the helper quotes the bond price at par, the par rate is baked into the bond coupons
+        }
         QuantLib::Real impliedQuote(
             const YieldTermStructureHandle& estimatingTermStructure,
             const YieldTermStructureHandle& discountingTermStructure = {}
@@ -296,12 +349,15 @@ namespace QLUtils {
         ParRate(
             const QuantLib::Period& tenor,
             const QuantLib::Date& baseReferenceDate,
-            const QuantLib::Period& forwardStart = QuantLib::Period(0, QuantLib::Days)
+            const QuantLib::Period& forwardStart = QuantLib::Period(0, QuantLib::Days),
+            const ValuationContext& valuationContext = {}
         ) :
             ParRateInstrument(tenor),
             baseReferenceDate_(baseReferenceDate),
             forwardStart_(forwardStart)
-        {}
+        {
+            this->valuationContext() = valuationContext;
+        }
         QuantLib::Date& baseReferenceDate() {
             return baseReferenceDate_;
         }
@@ -317,6 +373,13 @@ namespace QLUtils {
         std::string instrumentTypeAlias() const override {  // BootstrapInstrument
             return "par rate";
         }
+        std::string definitionKey() const override {    // BootstrapInstrument
+            std::ostringstream oss;
+            oss << ParRateInstrument::definitionKey();
+            oss << "|" << baseReferenceDate_.serialNumber();
+            oss << "|" << forwardStart_;
+            return oss.str();
+        }
         QuantLib::DayCounter parYieldSplineDayCounter() const override { // IParRateInstrument
             return ParYieldHelperType::parBondDayCounter();
         }
@@ -325,7 +388,8 @@ namespace QLUtils {
             FixedRateBondHelperPtr helper = ParYieldHelperType(tenor())
                 .withParYield(parRate())
                 .withBaseReferenceDate(baseReferenceDate())
-                .withForwardStart(forwardStart());
+                .withForwardStart(forwardStart())
+                .withValuationContext(valuationContext());
             return helper;
         }
         QuantLib::Rate impliedParRate(  // IParRateInstrument
@@ -336,14 +400,16 @@ namespace QLUtils {
             return ParYieldHelperType::parYield(
                 discountingTermStructure.currentLink(),
                 tenor(),
-                forwardStart()
+                forwardStart(),
+                valuationContext()
             );
         }
     };
 
     class IborIndexInstrument : public BootstrapInstrument {
-    protected:
+    private:
         IborIndexFactory iborIndexFactory_;
+        std::string iborIndexKey_;  // name and conventions of the index the factory makes, set with the factory
     public:
         typedef QuantLib::ext::shared_ptr<QuantLib::IborIndex> pIborIndex;
     public:
@@ -352,19 +418,38 @@ namespace QLUtils {
             const BootstrapInstrument::ValueType& valueType,
             const QuantLib::Period& tenor = QuantLib::Period(),
             const QuantLib::Date& datedDate = QuantLib::Date()
-        ) : BootstrapInstrument(valueType, tenor, datedDate), iborIndexFactory_(iborIndexFactory)
-        {}
+        ) : BootstrapInstrument(valueType, tenor, datedDate)
+        {
+            setIborIndexFactory(iborIndexFactory);
+        }
         const IborIndexFactory& iborIndexFactory() const {
             return iborIndexFactory_;
         }
-        IborIndexFactory& iborIndexFactory() {
-            return iborIndexFactory_;
+        void setIborIndexFactory(
+            const IborIndexFactory& iborIndexFactory
+        ) {
+            iborIndexFactory_ = iborIndexFactory;
+            iborIndexKey_.clear();
+            if (iborIndexFactory_) {
+                auto iborIndex = makeIborIndex();
+                std::ostringstream oss;
+                oss << "|" << iborIndex->name();
+                oss << "|" << iborIndex->fixingDays();
+                oss << "|" << iborIndex->fixingCalendar().name();
+                oss << "|" << iborIndex->businessDayConvention();
+                oss << "|" << iborIndex->endOfMonth();
+                iborIndexKey_ = oss.str();
+            }
         }
         pIborIndex makeIborIndex(
             const QuantLib::Handle<QuantLib::YieldTermStructure>& h = {}    // estimating term structure
         ) const {
             return iborIndexFactory()(h);
         }
+        // the rate helpers are built from the index the factory makes, so its name and conventions are part of the definition
+        std::string definitionKey() const override {    // BootstrapInstrument
+            return BootstrapInstrument::definitionKey() + iborIndexKey_;
+        }
     };
 
     class SwapCurveInstrument : public IborIndexInstrument {
@@ -407,9 +492,8 @@ namespace QLUtils {
         ) :
             SwapCurveInstrument(iborIndexFactory, BootstrapInstrument::vtRate, SwapCurveInstrument::Deposit, tenor)
         {
-            if (refDate == QuantLib::Date()) {
-                refDate = QuantLib::Settings::instance().evaluationDate();
-            }
+            this->valuationContext() = ValuationContext(refDate);
+            refDate = this->valuationContext().evaluationDate();
             auto iborIndex = makeIborIndex();
             fixingDays_ = iborIndex->fixingDays();
             fixingCalendar_ = iborIndex->fixingCalendar();
@@ -554,18 +638,22 @@ namespace QLUtils {
             auto days = immDate - d;
             return days * QuantLib::Days;
         }
-        IMMFuture(const IborIndexFactory& iborIndexFactory, QuantLib::Natural immOrdinal) :
+        IMMFuture(const IborIndexFactory& iborIndexFactory, QuantLib::Natural immOrdinal, const ValuationContext& valuationContext = {}) :
             SwapCurveInstrument(iborIndexFactory, BootstrapInstrument::vtPrice, SwapCurveInstrument::Future, QuantLib::Period(), QuantLib::Null < QuantLib::Date >()),
             immOrdinal_(immOrdinal), convexityAdj_(0.0) {
-            this->datedDate_ = IMMMainCycleStartDateForOrdinal(immOrdinal);
-            this->tenor_ = calculateTenor(this->datedDate_);
+            this->valuationContext() = valuationContext;
+            auto today = valuationContext.evaluationDate();
+            this->datedDate_ = IMMMainCycleStartDateForOrdinal(immOrdinal, today);
+            this->tenor_ = calculateTenor(this->datedDate_, today);
             this->immTicker_ = QuantLib::IMM::code(this->datedDate_);
         }
-        IMMFuture(const IborIndexFactory& iborIndexFactory, const QuantLib::Date& immDate) :
-            SwapCurveInstrument(iborIndexFactory, BootstrapInstrument::vtPrice, SwapCurveInstrument::Future, calculateTenor(immDate), immDate),
-            immOrdinal_(IMMMainCycleOrdinalForStartDate(immDate)),
+        IMMFuture(const IborIndexFactory& iborIndexFactory, const QuantLib::Date& immDate, const ValuationContext& valuationContext = {}) :
+            SwapCurveInstrument(iborIndexFactory, BootstrapInstrument::vtPrice, SwapCurveInstrument::Future, calculateTenor(immDate, valuationContext.evaluationDate()), immDate),
+            immOrdinal_(IMMMainCycleOrdinalForStartDate(immDate, valuationContext.evaluationDate())),
             immTicker_(QuantLib::IMM::code(immDate)),
-            convexityAdj_(0.0){}
+            convexityAdj_(0.0) {
+            this->valuationContext() = valuationContext;
+        }
         const QuantLib::Date& immDate() const {
             return this->datedDate_;
         }
@@ -581,6 +669,12 @@ namespace QLUtils {
         QuantLib::Rate& convexityAdj() {
             return convexityAdj_;
         }
+        std::string definitionKey() const override {    // BootstrapInstrument
+            std::ostringstream oss;
+            oss << SwapCurveInstrument::definitionKey();
+            oss << "|" << convexityAdj_;
+            return oss.str();
+        }
         QuantLib::Date immEndDate() const {
             return QuantLib::IMM::nextDate(immDate(), true);
         }
@@ -606,6 +700,16 @@ namespace QLUtils {
             );
             return helper;
         }
+        bool updateRateHelper(
+            const pRateHelper& helper,
+            const YieldTermStructureHandle& discountingTermStructure = {}
+        ) const override {
+            auto futuresHelper = QuantLib::ext::dynamic_pointer_cast<QuantLib::FuturesRateHelper>(helper);
+            if (futuresHelper == nullptr || futuresHelper->convexityAdjustment() != convexityAdj()) {   // the convexity adjustment quote is not reachable from the helper
+                return false;
+            }
+            return SwapCurveInstrument::updateRateHelper(helper, discountingTermStructure);
+        }
         QuantLib::Real impliedQuote(
             const QuantLib::Handle<QuantLib::YieldTermStructure>& estimatingTermStructure,
             const QuantLib::Handle<QuantLib::YieldTermStructure>& discountingTermStructure = QuantLib::Handle<QuantLib::YieldTermStructure>()
@@ -736,10 +840,11 @@ namespace QLUtils {
             swapTraits_(tenor),
             fixingResult_(swapTraits_.calculateFixing(refDate))
         {
+            this->valuationContext() = ValuationContext(refDate);
             const auto& swapTraits = this->swapTraits_;
-            this->iborIndexFactory_ = [&swapTraits](const YieldTermStructureHandle& h) {
+            this->setIborIndexFactory([&swapTraits](const YieldTermStructureHandle& h) {
                 return swapTraits.makeIborIndex(h);
-            };
+            });
             this->datedDate() = makeSwapInternal()->maturityDate(); // calculate the swap maturity date
         }
         const QuantLib::Calendar& fixingCalendar() const {
@@ -767,7 +872,8 @@ namespace QLUtils {
             return swapTraits_.makeRateHelper(
                 this->rate(),   // quotedFixedRate
                 startDate(),    // startDate
-                discountingTermStructure    // discountingTermStructure - exogenous discounting curve
+                discountingTermStructure,    // discountingTermStructure - exogenous discounting curve
+                valuationContext()  // valuationContext - provides today
             );
         }
         // given both estimating and discounting term structures, calculate the swap's implied fair fixed rate
@@ -874,10 +980,11 @@ namespace QLUtils {
             targetFixingResult_(targetSwapTraits_.calculateFixing(refDate)),
             baseFixingResult_(baseSwapTraits_.calculateFixing(refDate))
         {
+            this->valuationContext() = ValuationContext(refDate);
             const auto& swapTraits = this->targetSwapTraits_;
-            this->iborIndexFactory_ = [&swapTraits](const YieldTermStructureHandle& h) {
+            this->setIborIndexFactory([&swapTraits](const YieldTermStructureHandle& h) {
                 return swapTraits.makeIborIndex(h);
-            };
+            });
             QL_REQUIRE(baseSwapTraits_.bothLegsCouponsAligned(true), "for Vanilla-OIS basis swap, the base OIS swap's fixed leg and overnight leg coupons must be aligned");
             QL_REQUIRE(targetSwapTraits_.bothLegsCouponsAligned(true), "for Vanilla-OIS basis swap, the target vanilla swap's fixed leg and floating leg coupons must be aligned");
             baseSwapMaturityDate_ = makeBaseSwap()->maturityDate();  // calculate the base swap maturity date
@@ -886,6 +993,9 @@ namespace QLUtils {
         bool spreadIsOnBaseLeg() const {
             return spreadIsOnBaseLeg_;
         }
+        std::string definitionKey() const override {    // BootstrapInstrument
+            return SwapCurveInstrument::definitionKey() + (spreadIsOnBaseLeg_ ? "|base" : "|target");
+        }
         std::string instrumentTypeAlias() const override {
             return "basis swap";
         }
@@ -1007,14 +1117,21 @@ namespace QLUtils {
             QuantLib::Rate targetSwapFairRate = solver.solve(f, solverAccuracy(), targetSwapFairRateGuess, solverRateStep());
             return targetSwapFairRate;
         }
+        // the helper quotes the target swap fair rate implied by the quoted basis spread
+        QuantLib::Real rateHelperQuoteValue(
+            const YieldTermStructureHandle& discountingTermStructure = {}
+        ) const override {
+            quotedSpreadImpliedTargetSwapFairRate_ = calculateQuotedSpreadImpliedTargetSwapFairRate(discountingTermStructure);
+            return quotedSpreadImpliedTargetSwapFairRate_;
+        }
         pRateHelper rateHelper(
             const YieldTermStructureHandle& discountingTermStructure = {} 
         ) const override {
-            quotedSpreadImpliedTargetSwapFairRate_ = calculateQuotedSpreadImpliedTargetSwapFairRate(discountingTermStructure);
             auto helper = targetSwapTraits_.makeRateHelper(
-                quotedSpreadImpliedTargetSwapFairRate_,
+                rateHelperQuoteValue(discountingTermStructure),
                 targetSwapStartDate(),
-                discountingTermStructure
+                discountingTermStructure,
+                valuationContext()
             );
             return helper;
         }
@@ -1148,6 +1265,13 @@ namespace QLUtils {
         IborIndexFactory getIborFactory() const {
             return getIborFactory(lengthInMonths(), familyName());
         }
+        std::string definitionKey() const override {    // BootstrapInstrument
+            std::ostringstream oss;
+            oss << FRA::definitionKey();
+            oss << "|" << lengthInMonths_;
+            oss << "|" << familyName_;
+            return oss.str();
+        }
     };
 
     // for converting forward par rate curve to zero curve (forward-par-to-zero bootstrapping)
@@ -1160,12 +1284,14 @@ namespace QLUtils {
     public:
         ParForward(
             const QuantLib::Period& tenor,
-            const QuantLib::Period& forward
+            const QuantLib::Period& forward,
+            const ValuationContext& valuationContext = {}
         ) :
             ParRate<COUPON_FREQ, THIRTY_360_DC_CONVENTION>(
                 tenor,
-                QuantLib::Settings::instance().evaluationDate(),
-                forward
+                valuationContext.evaluationDate(),
+                forward,
+                valuationContext
             )
         {}
     };
@@ -1178,9 +1304,10 @@ namespace QLUtils {
     class ParSpot : public ParForward<COUPON_FREQ, THIRTY_360_DC_CONVENTION> {
     public:
         ParSpot(
-            const QuantLib::Period& tenor
+            const QuantLib::Period& tenor,
+            const ValuationContext& valuationContext = {}
         ) :
-            ParForward<COUPON_FREQ, THIRTY_360_DC_CONVENTION>(tenor, QuantLib::Period(0, QuantLib::Days))
+            ParForward<COUPON_FREQ, THIRTY_360_DC_CONVENTION>(tenor, QuantLib::Period(0, QuantLib::Days), valuationContext)
         {}
     };
 
@@ -1212,6 +1339,12 @@ namespace QLUtils {
         {
             this->datedDate() = helperInternal_.startDate();
         }
+        std::string definitionKey() const override {    // BootstrapInstrument
+            std::ostringstream oss;
+            oss << BootstrapInstrument::definitionKey();
+            oss << "|" << helperInternal_.baseReferenceDate().serialNumber();
+            return oss.str();
+        }
         QuantLib::Date startDate() const {
             return helperInternal_.startDate();
         }
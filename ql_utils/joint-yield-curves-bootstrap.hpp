@@ -0,0 +1,269 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/bootstrap.hpp>
+#include <ql_utils/fitted-yield-curve-bootstrap.hpp>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+namespace QuantLib {
+    namespace Utils {
+        // simultaneous bootstrap of a discount curve and an estimating curve that depend on each other, e.g. an OIS discount curve
+        // whose long end comes from basis swaps quoted against the estimating curve, while the estimating curve's instruments are
+        // discounted on the discount curve
+        // every instrument has its pillar on one of the two curves and is priced with impliedQuote(projection curve, discounting curve).
+        // the pillar values of both curves form one unknown vector, solved by a damped Newton iteration on the instruments' residuals
+        // with the full (block) Jacobian across both helper sets, calculated by central differences as in YieldCurveJacobian
+        // this replaces the outer fixed-point loop of full piecewise bootstraps, each of which would treat the other curve as exogenous
+        template <
+            typename Traits = ZeroYield,   // ZeroYield, Discount, ForwardRate, or SimpleZeroYield
+            typename Interpolator = Linear  // Linear, BackwardFlat, ConvexMonotone, or LogLinear
+        >
+        class JointYieldCurvesBootstrap : public Bootstrapper {
+        public:
+            typedef typename Traits::template curve<Interpolator>::type BaseCurveType;
+            enum CurveId {
+                DiscountCurve = 0,
+                EstimatingCurve = 1
+            };
+            struct Node {
+                pInstrument instrument;
+                CurveId pillarCurve;    // curve the instrument's pillar is on
+                CurveId projectionCurve;    // estimating term structure passed to impliedQuote()
+                CurveId discountingCurve;   // discounting term structure passed to impliedQuote()
+            };
+        private:
+            std::vector<Date> dates_[2];    // curve nodes, dates_[c][0] is the reference date
+            std::vector<Size> nodeIndex_[2];    // nodeIndex_[c][k] = node with pillar k + 1 on curve c
+            DayCounter dayCounter_;
+            Interpolator interp_;
+        public:
+            // input
+            std::vector<Node> nodes;
+            QLUtils::ValuationContext valuationContext; // as-of date for the bootstrap (global evaluation date if empty)
+            Size maxIterations;
+            Real accuracy;  // on the max absolute residual, in decimal units (implied - actual) * absoluteDiffMultiplier
+            Real bumpSize;  // pillar bump for the Jacobian
+        public:
+            // output
+            ext::shared_ptr<BaseCurveType> discountCurve;
+            ext::shared_ptr<BaseCurveType> estimatingCurve;
+            Size iterations;
+            Real maxResidual;
+        public:
+            JointYieldCurvesBootstrap() : maxIterations(50), accuracy(1.0e-12), bumpSize(1.0e-6), iterations(0), maxResidual(Null<Real>()) {}
+            // instrument with its pillar on the discount curve. by default it is priced on the discount curve alone, set
+            // projectionCurve = EstimatingCurve for e.g. a basis swap whose other leg is projected off the estimating curve
+            void addDiscountCurveInstrument(
+                const pInstrument& inst,
+                CurveId projectionCurve = DiscountCurve
+            ) {
+                nodes.push_back(Node{inst, DiscountCurve, projectionCurve, DiscountCurve});
+            }
+            // instrument with its pillar on the estimating curve, projected off the estimating curve and discounted on the discount curve
+            void addEstimatingCurveInstrument(
+                const pInstrument& inst
+            ) {
+                nodes.push_back(Node{inst, EstimatingCurve, EstimatingCurve, DiscountCurve});
+            }
+            void clearOutputs() {
+                discountCurve = nullptr;
+                estimatingCurve = nullptr;
+                iterations = 0;
+                maxResidual = Null<Real>();
+            }
+        private:
+            Size numPillars(Size c) const {
+                return dates_[c].size() - 1;
+            }
+            // unknown vector layout: discount curve pillars first, then the estimating curve's
+            Size offset(Size c) const {
+                return (c == DiscountCurve ? 0 : numPillars(DiscountCurve));
+            }
+            ext::shared_ptr<BaseCurveType> curve(Size c, const Array& x) const {
+                std::vector<Real> data(dates_[c].size(), Traits::initialValue(nullptr));
+                for (Size k = 0; k < numPillars(c); ++k) {
+                    Traits::updateGuess(data, x[offset(c) + k], k + 1);
+                }
+                ext::shared_ptr<BaseCurveType> ts(new BaseCurveType(dates_[c], data, dayCounter_, interp_));
+                ts->enableExtrapolation();  // instruments may reach slightly past their pillars
+                return ts;
+            }
+            // residuals of the nodes priced on the changed curve (all of them if changedCurve == Null<Size>())
+            void residuals(
+                const ext::shared_ptr<BaseCurveType>& discountTS,
+                const ext::shared_ptr<BaseCurveType>& estimatingTS,
+                Size changedCurve,
+                Array& r
+            ) const {
+                YieldTermStructureHandle h[2] = {YieldTermStructureHandle(discountTS), YieldTermStructureHandle(estimatingTS)};
+                for (Size c = 0; c < 2; ++c) {
+                    for (Size k = 0; k < numPillars(c); ++k) {
+                        const auto& node = nodes[nodeIndex_[c][k]];
+                        if (changedCurve != Null<Size>() && node.projectionCurve != changedCurve && node.discountingCurve != changedCurve) {
+                            continue;
+                        }
+                        const auto& inst = node.instrument;
+                        auto implied = inst->impliedQuote(h[node.projectionCurve], h[node.discountingCurve]);
+                        r[offset(c) + k] = (implied - inst->value()) * inst->absoluteDiffMultiplier();
+                    }
+                }
+            }
+            Array residuals(const Array& x) const {
+                Array r(x.size());
+                residuals(curve(DiscountCurve, x), curve(EstimatingCurve, x), Null<Size>(), r);
+                return r;
+            }
+            // block Jacobian of the residuals in the pillar values of both curves
+            Matrix jacobian(const Array& x) const {
+                auto n = x.size();
+                Matrix jac(n, n, 0.0);
+                ext::shared_ptr<BaseCurveType> base[2] = {curve(DiscountCurve, x), curve(EstimatingCurve, x)};
+                Array up(n, 0.0), down(n, 0.0);
+                for (Size c = 0; c < 2; ++c) {
+                    for (Size k = 0; k < numPillars(c); ++k) {
+                        auto i = offset(c) + k;
+                        auto bumped = x;
+                        bumped[i] = x[i] + bumpSize;
+                        auto upTS = curve(c, bumped);
+                        bumped[i] = x[i] - bumpSize;
+                        auto downTS = curve(c, bumped);
+                        // only the nodes priced on curve c are repriced, the others have zero sensitivity to it
+                        residuals(c == DiscountCurve ? upTS : base[DiscountCurve], c == EstimatingCurve ? upTS : base[EstimatingCurve], c, up);
+                        residuals(c == DiscountCurve ? downTS : base[DiscountCurve], c == EstimatingCurve ? downTS : base[EstimatingCurve], c, down);
+                        for (Size cj = 0; cj < 2; ++cj) {
+                            for (Size kj = 0; kj < numPillars(cj); ++kj) {
+                                const auto& node = nodes[nodeIndex_[cj][kj]];
+                                if (node.projectionCurve == c || node.discountingCurve == c) {
+                                    auto j = offset(cj) + kj;
+                                    jac[j][i] = (up[j] - down[j]) / (2.0 * bumpSize);
+                                }
+                            }
+                        }
+                    }
+                }
+                return jac;
+            }
+            static Real maxAbs(const Array& a) {
+                Real ret = 0.0;
+                for (auto v : a) {
+                    ret = std::max(ret, std::fabs(v));
+                }
+                return ret;
+            }
+            void setupPillars(const Date& curveReferenceDate) {
+                std::vector<std::pair<Date, Size>> pillars[2];
+                for (Size i = 0; i < nodes.size(); ++i) {
+                    const auto& node = nodes[i];
+                    QL_REQUIRE(node.instrument != nullptr, io::ordinal(i + 1) << " instrument is null");
+                    if (!node.instrument->use()) {
+                        continue;
+                    }
+                    node.instrument->ensureValueIsSet();
+                    auto d = node.instrument->maturityDate();
+                    QL_REQUIRE(d > curveReferenceDate, "instrument " << node.instrument->ticker() << " matures (" << d << ") on or before the curve reference date (" << curveReferenceDate << ")");
+                    pillars[node.pillarCurve].emplace_back(d, i);
+                }
+                for (Size c = 0; c < 2; ++c) {
+                    QL_REQUIRE(pillars[c].size() + 1 >= Interpolator::requiredPoints, "not enough instruments for the " << (c == DiscountCurve ? "discount" : "estimating") << " curve: " << pillars[c].size() << " provided, " << Interpolator::requiredPoints - 1 << " required");
+                    std::sort(pillars[c].begin(), pillars[c].end());
+                    dates_[c].assign(1, curveReferenceDate);
+                    nodeIndex_[c].clear();
+                    for (const auto& p : pillars[c]) {
+                        QL_REQUIRE(p.first != dates_[c].back(), "more than one instrument with pillar " << p.first << " on the " << (c == DiscountCurve ? "discount" : "estimating") << " curve");
+                        dates_[c].push_back(p.first);
+                        nodeIndex_[c].push_back(p.second);
+                    }
+                }
+            }
+        public:
+            void bootstrap(
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter = Actual365Fixed(),
+                const Interpolator& interp = Interpolator()
+            ) {
+                clearOutputs();
+                QL_REQUIRE(!nodes.empty(), "instruments cannot be empty");
+                QL_REQUIRE(bumpSize > 0.0, "bump size (" << bumpSize << ") must be positive");
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                dayCounter_ = dayCounter;
+                interp_ = interp;
+                setupPillars(curveReferenceDate);
+                // flat initial guess
+                ext::shared_ptr<YieldTermStructure> guessCurve(new FlatForward(curveReferenceDate, detail::avgRate, dayCounter_));
+                Array x(numPillars(DiscountCurve) + numPillars(EstimatingCurve));
+                for (Size c = 0; c < 2; ++c) {
+                    for (Size k = 0; k < numPillars(c); ++k) {
+                        x[offset(c) + k] = FittedCurveCoordinates<Traits>::value(*guessCurve, dayCounter_.yearFraction(curveReferenceDate, dates_[c][k + 1]));
+                    }
+                }
+                auto r = residuals(x);
+                auto err = maxAbs(r);
+                Size iteration = 0;
+                while (err > accuracy) {
+                    QL_REQUIRE(iteration < maxIterations, "joint bootstrap did not converge after " << iteration << " iterations, max residual " << err << ", required accuracy " << accuracy);
+                    ++iteration;
+                    auto step = qrSolve(jacobian(x), r);
+                    // damped Newton step, halved until the residuals decrease
+                    Real lambda = 1.0;
+                    Array next;
+                    Array nextR;
+                    Real nextErr = QL_MAX_REAL;
+                    for (Size halvings = 0; halvings < 20; ++halvings, lambda *= 0.5) {
+                        next = x - lambda * step;
+                        try {
+                            nextR = residuals(next);
+                            nextErr = maxAbs(nextR);
+                        }
+                        catch (...) {   // e.g. negative discount factors on a too long step
+                            nextErr = QL_MAX_REAL;
+                        }
+                        if (nextErr < err) {
+                            break;
+                        }
+                    }
+                    QL_REQUIRE(nextErr < err, "joint bootstrap stalled at iteration " << iteration << ", max residual " << err);
+                    x = next;
+                    r = nextR;
+                    err = nextErr;
+                }
+                discountCurve = curve(DiscountCurve, x);
+                estimatingCurve = curve(EstimatingCurve, x);
+                iterations = iteration;
+                maxResidual = err;
+            }
+            template<
+                typename ActualVsImpliedComparison = DefaultActualVsImpliedComparison
+            >
+            Rate verify(
+                std::ostream& os,
+                std::streamsize precision = 16,
+                const ActualVsImpliedComparison& compare = ActualVsImpliedComparison()
+            ) const {
+                QL_REQUIRE(discountCurve != nullptr && estimatingCurve != nullptr, "curves are not bootstrapped");
+                QLUtils::ValuationContext::EvaluationDateScope evaluationDateScope(valuationContext);
+                YieldTermStructureHandle h[2] = {YieldTermStructureHandle(discountCurve), YieldTermStructureHandle(estimatingCurve)};
+                Instruments instruments;
+                std::unordered_map<const Instrument*, const Node*> nodeOf;
+                for (const auto& node : nodes) {
+                    instruments.push_back(node.instrument);
+                    nodeOf[node.instrument.get()] = &node;
+                }
+                return verifyImpl(
+                    instruments,
+                    [&h, &nodeOf](const pInstrument& pInst) -> Real {
+                        const auto& node = *nodeOf.at(pInst.get());
+                        return pInst->impliedQuote(h[node.projectionCurve], h[node.discountingCurve]);
+                    },
+                    os,
+                    precision,
+                    compare
+                );
+            }
+        };
+    }
+}
@@ -8,6 +8,7 @@
 #include <ql_utils/bootstrap.hpp>
 #include <ql_utils/dateformat.hpp>
 #include <ql_utils/ratehelpers/nominal_forward_ratehelper.hpp>
+#include <ql_utils/utilities/monthly-date-grid.hpp>
 #include <memory>
 #include <vector>
 #include <iostream>
@@ -68,6 +69,14 @@ namespace QuantLib {
                 this->shockedCurve = bootstrap.discountCurve;
             }
         protected:
+            // monthly periods and dates of the curve's reference date up to its max date, shared with the other shocks of the same curve dates
+            QLUtils::pMonthlyDateGrid monthlyDateGrid() const {
+                return QLUtils::MonthlyDateGridCache::instance().grid(
+                    this->yieldTermStructure->referenceDate(),
+                    this->yieldTermStructure->maxDate(),
+                    this->yieldTermStructure->dayCounter()
+                );
+            }
             // the actual shock implementation
             virtual void shockImpl(
                 const MonthlyRateShocker& monthlyRateShocker
@@ -115,6 +124,23 @@ namespace QuantLib {
                     compare
                 );
             }
+            Rate verify(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool = nullptr
+            ) const {
+                this->verifyOutputs();
+                this->shockedCurve->discount(0);    // make sure the curve is calculated before any parallel access
+                YieldTermStructureHandle shockedTS(this->shockedCurve);
+                const auto& me = *this;
+                return verifyImpl(
+                    *shockedQuotes,
+                    [&shockedTS, &me](const pInstrument& pInst) -> Rate {
+                        return me.impliedRate(pInst, shockedTS);
+                    },
+                    report,
+                    pool
+                );
+            }
             void monthlyRampShock(
                 const monthly_ramp& monthlyRamp,
                 const DayCounter& curveDayCounter
@@ -266,11 +292,11 @@ namespace QuantLib {
                 auto curveReferenceDate = this->yieldTermStructure->referenceDate();
                 auto maxDate = this->yieldTermStructure->maxDate();
                 auto tenor = Period(TENOR_MONTHS, Months);
+                auto dateGrid = this->monthlyDateGrid();    // forward start dates, the forward months past the grid mature after maxDate
                 MonthNumber forwardMonth = 0;
-                Period forward(forwardMonth, Months);
-                auto maturityDate = curveReferenceDate + forward + tenor;
+                auto maturityDate = dateGrid->date(forwardMonth) + tenor;
                 while (maturityDate <= maxDate) {
-                    Period forward(forwardMonth, Months);
+                    const auto& forward = dateGrid->period(forwardMonth);
                     auto rate = NominalForwardRateHelper::impliedRate(
                         *(this->yieldTermStructure),
                         forward,
@@ -291,7 +317,7 @@ namespace QuantLib {
                     this->monthlyShocks.push_back(shock);
                     this->shockedQuotes->push_back(pInst);
                     forwardMonth++;
-                    maturityDate = curveReferenceDate + Period(forwardMonth, Months) + tenor;
+                    maturityDate = (forwardMonth < dateGrid->size() ? dateGrid->date(forwardMonth) + tenor : Date::maxDate());
                 };
             }
             Rate impliedRate(
@@ -138,6 +138,24 @@ namespace QuantLib {
                     compare
                 );
             }
+            Rate verify(
+                VerificationReport& report,
+                QLUtils::ThreadPool* pool = nullptr
+            ) const {
+                QL_REQUIRE(discountCurve != nullptr, "discount zero curve cannot be null");
+                checkParInstruments();
+                discountCurve->discount(0); // make sure the curve is calculated before any parallel access
+                Handle<YieldTermStructure> discountingTermStructure(discountCurve);
+                return verifyImpl(
+                    parInstruments,
+                    [&discountingTermStructure](const pInstrument& inst) -> Rate {
+                        auto parInstrument = std::dynamic_pointer_cast<QLUtils::IParRateInstrument>(inst);
+                        return parInstrument->impliedParRate(discountingTermStructure);
+                    },
+                    report,
+                    pool
+                );
+            }
         };
     }
 }
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/instrument.hpp>
+#include <string>
+#include <map>
+#include <mutex>
+
+namespace QLUtils {
+    // cache of the rate helpers created by the bootstrap instruments, keyed by BootstrapInstrument::definitionKey()
+    // building a helper builds its schedules, indexes, and dates. re-curving with the same instrument definitions re-uses the cached
+    // helpers and only pushes the new quoted values into them (BootstrapInstrument::updateRateHelper())
+    // a helper built on another evaluation date is only re-used if it re-dates itself when the evaluation date changes
+    // (QuantLib::RelativeDateRateHelper, e.g. deposits, FRAs, and swaps), otherwise it is rebuilt for the instrument's evaluation date
+    // helpers of an exogenous discount curve bootstrap are all built on the cache's own relinkable discount handle, which is re-linked
+    // to the discount curve of each request, so that a new discount curve does not invalidate them
+    // a cached helper is shared by every curve built from it: a curve bootstrapped from the cache is only valid until the cache is used
+    // for the next bootstrap of the same instruments. use one cache per curve definition (e.g. per YieldCurvesBootstrap)
+    class RateHelperCache {
+    public:
+        typedef QuantLib::ext::shared_ptr<QuantLib::RateHelper> pRateHelper;
+        typedef QuantLib::ext::shared_ptr<QuantLib::YieldTermStructure> YieldTermStructurePtr;
+        typedef QuantLib::Handle<QuantLib::YieldTermStructure> YieldTermStructureHandle;
+    private:
+        struct Entry {
+            pRateHelper helper;
+            QuantLib::Date evaluationDate;
+        };
+        std::map<std::string, Entry> entries_;
+        QuantLib::RelinkableHandle<QuantLib::YieldTermStructure> discountHandle_;
+        QuantLib::Size hits_;
+        QuantLib::Size misses_;
+        mutable std::mutex mutex_;
+    private:
+        // true if the helper moves its dates with the evaluation date
+        static bool reDatesItself(
+            const pRateHelper& helper
+        ) {
+            return (QuantLib::ext::dynamic_pointer_cast<QuantLib::RelativeDateRateHelper>(helper) != nullptr);
+        }
+    public:
+        RateHelperCache() : hits_(0), misses_(0) {}
+        RateHelperCache(const RateHelperCache&) = delete;
+        RateHelperCache& operator = (const RateHelperCache&) = delete;
+        // rate helper of the instrument carrying its current quoted value, re-used from the cache when possible
+        // exogenousDiscountTS is nullptr when bootstrapping both estimating and discounting term structures concurrently
+        pRateHelper rateHelper(
+            const BootstrapInstrument& inst,
+            const YieldTermStructurePtr& exogenousDiscountTS = nullptr
+        ) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            YieldTermStructureHandle hDiscountTS;
+            if (exogenousDiscountTS != nullptr) {
+                if (discountHandle_.currentLink() != exogenousDiscountTS) {
+                    discountHandle_.linkTo(exogenousDiscountTS);
+                }
+                hDiscountTS = discountHandle_;
+            }
+            auto key = inst.definitionKey() + (exogenousDiscountTS != nullptr ? "|exogenous" : "|concurrent");
+            auto evaluationDate = inst.valuationContext().evaluationDate();
+            auto p = entries_.find(key);
+            if (p != entries_.end() && (p->second.evaluationDate == evaluationDate || reDatesItself(p->second.helper)) && inst.updateRateHelper(p->second.helper, hDiscountTS)) {
+                ++hits_;
+                p->second.evaluationDate = evaluationDate;
+                return p->second.helper;
+            }
+            ++misses_;
+            auto& entry = entries_[key];
+            entry.helper = inst.rateHelper(hDiscountTS);
+            entry.evaluationDate = evaluationDate;
+            return entry.helper;
+        }
+        // drops the helpers last used for evaluation dates before the given date
+        void purge(
+            const QuantLib::Date& evaluationDate
+        ) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto p = entries_.begin(); p != entries_.end();) {
+                if (p->second.evaluationDate < evaluationDate) {
+                    p = entries_.erase(p);
+                }
+                else {
+                    ++p;
+                }
+            }
+        }
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.clear();
+            hits_ = 0;
+            misses_ = 0;
+        }
+        QuantLib::Size size() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+        QuantLib::Size hits() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return hits_;
+        }
+        QuantLib::Size misses() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return misses_;
+        }
+    };
+}
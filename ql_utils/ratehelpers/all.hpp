@@ -2,3 +2,4 @@
 
 #include <ql_utils/ratehelpers/swap-rate-helper-ex.hpp>
 #include <ql_utils/ratehelpers/nominal_forward_ratehelper.hpp>
+#include <ql_utils/ratehelpers/instrumented-ratehelper.hpp>
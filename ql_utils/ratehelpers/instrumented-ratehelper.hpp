@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <chrono>
+
+namespace QuantLib {
+    // forwarding rate helper that counts and times the implied quote calculations of the wrapped helper
+    // during a bootstrap the solver of a pillar reprices that pillar's helper only, so the counts and times are per pillar
+    class InstrumentedRateHelper : public RateHelper {
+    private:
+        typedef std::chrono::steady_clock Clock;
+        ext::shared_ptr<RateHelper> helper_;
+        mutable Size evaluations_;
+        mutable double seconds_;
+    public:
+        explicit InstrumentedRateHelper(
+            const ext::shared_ptr<RateHelper>& helper
+        ) : RateHelper(helper->quote()), helper_(helper), evaluations_(0), seconds_(0.0) {
+            registerWith(helper_);
+        }
+        const ext::shared_ptr<RateHelper>& helper() const {
+            return helper_;
+        }
+        Real impliedQuote() const override {
+            ++evaluations_;
+            auto start = Clock::now();
+            auto ret = helper_->impliedQuote();
+            seconds_ += std::chrono::duration<double>(Clock::now() - start).count();
+            return ret;
+        }
+        void setTermStructure(YieldTermStructure* t) override {
+            helper_->setTermStructure(t);
+            RateHelper::setTermStructure(t);
+        }
+        Date earliestDate() const override {
+            return helper_->earliestDate();
+        }
+        Date maturityDate() const override {
+            return helper_->maturityDate();
+        }
+        Date latestRelevantDate() const override {
+            return helper_->latestRelevantDate();
+        }
+        Date pillarDate() const override {
+            return helper_->pillarDate();
+        }
+        Date latestDate() const override {
+            return helper_->latestDate();
+        }
+        void accept(AcyclicVisitor& v) override {
+            helper_->accept(v);
+        }
+        // number of implied quote calculations since construction or the last resetStatistics()
+        Size evaluations() const {
+            return evaluations_;
+        }
+        // wall time spent in the implied quote calculations
+        double seconds() const {
+            return seconds_;
+        }
+        void resetStatistics() {
+            evaluations_ = 0;
+            seconds_ = 0.0;
+        }
+        // quote - implied quote, without being counted
+        Real residual() const {
+            return helper_->quoteError();
+        }
+    };
+}
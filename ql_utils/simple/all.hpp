@@ -1,7 +1,16 @@
 #pragma once
 
+#include <ql_utils/simple/span.hpp>
+#include <ql_utils/simple/math-kernels.hpp>
+#include <ql_utils/simple/monthly-discount-factors.hpp>
 #include <ql_utils/simple/rate-calculator.hpp>
+#include <ql_utils/simple/grid-discount-factors.hpp>
+#include <ql_utils/simple/grid-rate-calculator.hpp>
 #include <ql_utils/simple/ts-shock.hpp>
 #include <ql_utils/simple/rate-calculators/all.hpp>
 #include <ql_utils/simple/ts-shocks/all.hpp>
-#include <ql_utils/simple/bootstraps/all.hpp>
\ No newline at end of file
+#include <ql_utils/simple/bootstraps/all.hpp>
+#include <ql_utils/simple/scenario-matrix.hpp>
+#include <ql_utils/simple/scenario-batch.hpp>
+#include <ql_utils/simple/shock-pipeline.hpp>
+#include <ql_utils/simple/scenario-driver.hpp>
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
 
+#include <ql_utils/simple/bootstraps/par-spline-operator.hpp>
 #include <ql_utils/simple/bootstraps/par-yield-ts-bootstrap.hpp>
 #include <ql_utils/simple/bootstraps/forward-to-zero-converter.hpp>
\ No newline at end of file
@@ -3,11 +3,15 @@
 #include <ql/quantlib.hpp>
 #include <ql_utils/types.hpp>
 #include <ql_utils/simple/rate-calculators/fwd-rate-calculator.hpp>
+#include <ql_utils/simple/span.hpp>
 #include <memory>
+#include <vector>
 #include <cmath>
 
 namespace QLUtils {
 	// convert between montly zero rates and monthly forward curve
+	// the forwards are converted in log space through SimpleImpliedRateBatch: an IMPLIED_RATE_CALCULATOR with the optional batch
+	// logCompounding()/fromLogCompounding() members converts a whole curve per call, any other one is applied element by element
 	template <
 		typename IMPLIED_RATE_CALCULATOR = NominalSimpleImpliedRateCalculator,
 		RateUnit RATE_UNIT = RateUnit::Percent,
@@ -16,50 +20,146 @@ namespace QLUtils {
 	class SimpleForwardZeroConverter {
 	private:
 		using FwdRateCalculator = SimpleForwardRateCalculator<IMPLIED_RATE_CALCULATOR, RATE_UNIT, COUPON_FREQ>;
+		using MonthlyDiscountFactors = typename FwdRateCalculator::MonthlyDiscountFactors;
 	private:
 		SimpleForwardZeroConverter() {}
 	public:
 		// bootstrap a monthly forward curve to a monthly zero rate curve
 		static std::shared_ptr<MonthlyZeroRates> bootstrap(
 			const MonthlyForwardCurve& monthlyFwdCurve	// assuming tenor is 1 month and the fwd rate is interest rate calculated using IMPLIED_RATE_CALCULATOR
+		) {
+			QL_REQUIRE(monthlyFwdCurve.size() > 0, "forward curve is empty");
+			std::shared_ptr<MonthlyZeroRates> ret(new MonthlyZeroRates(monthlyFwdCurve.size() + 1));
+			bootstrap(monthlyFwdCurve, *ret);
+			return ret;
+		}
+		// cumulative log compounding of every month of the zero rates: logCompounding[month] = log((1 + zr/freq)^(t*freq)) = -log(df)
+		// logCompounding must have the zero rates' size (may be the same memory)
+		static void logCompounding(
+			SimpleConstRates monthlyZeroRates,
+			SimpleRates logCompounding
+		) {
+			MonthlyDiscountFactors::logCompoundings(monthlyZeroRates, logCompounding);
+		}
+		// inverse of logCompounding(), month 0 set to month 1. monthlyZeroRates must have the log compoundings' size (may be the same memory)
+		static void fromLogCompounding(
+			SimpleConstRates logCompounding,
+			SimpleRates monthlyZeroRates
+		) {
+			auto n_zeros = logCompounding.size();
+			QL_REQUIRE(n_zeros >= 2, "too few zero rate nodes (" << n_zeros << "). The minimum is 2");
+			QL_REQUIRE(monthlyZeroRates.size() == n_zeros, "zero rates buffer size (" << monthlyZeroRates.size() << ") must be the log compoundings' size (" << n_zeros << ")");
+			MonthlyDiscountFactors::zeroRates(logCompounding.subspan(1, n_zeros - 1), monthlyZeroRates.subspan(1, n_zeros - 1), 1);
+			monthlyZeroRates[0] = monthlyZeroRates[1];
+		}
+		// allocation free version of bootstrap() into the caller's zero rates, which must have one more element than the forward curve
+		// the cumulative log compounding is a prefix sum of the forwards' log compoundings, built in the zero rates buffer and converted in place,
+		// so it takes one log and one exp per month in batch kernel passes around the scan
+		static void bootstrap(
+			SimpleConstRates monthlyFwdCurve,	// assuming tenor is 1 month and the fwd rate is interest rate calculated using IMPLIED_RATE_CALCULATOR
+			SimpleRates zeroRates
 		) {
 			IMPLIED_RATE_CALCULATOR impliedRateCalculator;
 			auto n_forwards = monthlyFwdCurve.size();
 			QL_REQUIRE(n_forwards > 0, "forward curve is empty");
-			auto freq = FwdRateCalculator::couponFrequency();
 			auto multiplier = FwdRateCalculator::multiplier();
 			auto n_zeros = n_forwards + 1;	// n_forwards >= 1 => n_zeros >= 2
-			std::shared_ptr<MonthlyZeroRates> ret(new MonthlyZeroRates(n_zeros));
-			auto& zeroRates = *ret;
-			for (decltype(n_zeros) month = 0; month < n_zeros - 1; ++month) {	// n_zeros - 1 iterations (at least one), month_max = n_zeros - 2 = n_forwards - 1
-				auto nextMonth = month + 1;
-				auto t_0 = (QuantLib::Time)month / 12.;
-				auto t_1 = (QuantLib::Time)nextMonth / 12.;
-				auto dt = t_1 - t_0;
-				QuantLib::Real compounding_0 = (month == 0 ? 1. : std::pow(1. + zeroRates[month] * multiplier / freq, t_0 * freq));
-				QuantLib::Rate fwdRate = monthlyFwdCurve[month] * multiplier;
-				QuantLib::Real compounding_fwd = impliedRateCalculator.compounding(fwdRate, dt);	// calculate the forward compounding factor giving the forward rate
-				QuantLib::Real compounding_1 = compounding_0 * compounding_fwd;
-				QuantLib::Rate zr_1 = (std::pow(compounding_1, 1. / (t_1 * freq)) - 1.) * freq;
-				zeroRates[nextMonth] = zr_1 / multiplier;
+			QL_REQUIRE(zeroRates.size() == n_zeros, "zero rates buffer size (" << zeroRates.size() << ") must be the number of forwards + 1 (" << n_zeros << ")");
+			auto& logCompounding = zeroRates;
+			logCompounding[0] = 0.;
+			for (decltype(n_forwards) month = 0; month < n_forwards; ++month) {
+				logCompounding[month + 1] = monthlyFwdCurve[month] * multiplier;
+			}
+			SimpleImpliedRateBatch<IMPLIED_RATE_CALCULATOR>::logCompounding(impliedRateCalculator, &logCompounding[1], 1. / 12., &logCompounding[1], n_forwards);
+			for (decltype(n_zeros) month = 2; month < n_zeros; ++month) {	// prefix sum
+				logCompounding[month] += logCompounding[month - 1];
+			}
+			fromLogCompounding(logCompounding, zeroRates);
+		}
+		// allocation free forward curve of any tenor into the caller's buffer (zero rates' size - tenorMonth elements), from the difference
+		// of the cumulative log compoundings, kept in the logCompoundings work buffer
+		static void forwardCurve(
+			SimpleConstRates monthlyZeroRates,
+			SimpleRates fwdCurve,
+			size_t tenorMonth,
+			std::vector<QuantLib::Real>& logCompoundings
+		) {
+			auto n_zeros = monthlyZeroRates.size();
+			logCompoundings.resize(n_zeros);
+			logCompounding(monthlyZeroRates, logCompoundings);
+			forwardCurveFromLogCompounding(logCompoundings, fwdCurve, tenorMonth);
+		}
+		// allocation free monthly (1 month tenor) forward curve into the caller's buffer, which must have one element less than the zero rates
+		// the log compoundings are built in the forward curve buffer, differenced and converted in place
+		static void forwardCurve(
+			SimpleConstRates monthlyZeroRates,
+			SimpleRates monthlyFwdCurve
+		) {
+			IMPLIED_RATE_CALCULATOR impliedRateCalculator;
+			auto n_zeros = monthlyZeroRates.size();
+			QL_REQUIRE(n_zeros >= 2, "too few zero rate nodes (" << n_zeros << "). The minimum is 2");
+			QL_REQUIRE(monthlyFwdCurve.size() == n_zeros - 1, "forward curve buffer size (" << monthlyFwdCurve.size() << ") must be the number of zero rates - 1 (" << (n_zeros - 1) << ")");
+			auto multiplier = FwdRateCalculator::multiplier();
+			auto n_forwards = n_zeros - 1;
+			MonthlyDiscountFactors::logCompoundings(monthlyZeroRates.subspan(1, n_forwards), monthlyFwdCurve, 1);	// log compounding to the end of the forward
+			for (auto fwdMonth = n_forwards - 1; fwdMonth > 0; --fwdMonth) {	// log compounding over the forward
+				monthlyFwdCurve[fwdMonth] -= monthlyFwdCurve[fwdMonth - 1];
+			}
+			SimpleImpliedRateBatch<IMPLIED_RATE_CALCULATOR>::fromLogCompounding(impliedRateCalculator, monthlyFwdCurve.data(), 1. / 12., monthlyFwdCurve.data(), n_forwards);
+			for (decltype(n_forwards) fwdMonth = 0; fwdMonth < n_forwards; ++fwdMonth) {
+				monthlyFwdCurve[fwdMonth] /= multiplier;
+			}
+		}
+		// forward curve of any tenor from the cumulative log compoundings of a zero curve (see logCompounding())
+		// fwdCurve must have logCompounding.size() - tenorMonth elements
+		static void forwardCurveFromLogCompounding(
+			SimpleConstRates logCompounding,
+			SimpleRates fwdCurve,
+			size_t tenorMonth
+		) {
+			IMPLIED_RATE_CALCULATOR impliedRateCalculator;
+			auto n_zeros = logCompounding.size();
+			QL_REQUIRE(tenorMonth > 0, "tenor in month (" << tenorMonth << ") must be greater than zero");
+			QL_REQUIRE(tenorMonth < n_zeros, "tenor in month (" << tenorMonth << ") is over the limit (" << (n_zeros - 1) << ")");
+			auto n_forwards = n_zeros - tenorMonth;	// n_forwards > 0
+			QL_REQUIRE(fwdCurve.size() == n_forwards, "forward curve buffer size (" << fwdCurve.size() << ") must be the number of zero rates - tenor (" << n_forwards << ")");
+			auto multiplier = FwdRateCalculator::multiplier();
+			for (decltype(n_forwards) fwdMonth = 0; fwdMonth < n_forwards; ++fwdMonth) {
+				fwdCurve[fwdMonth] = logCompounding[fwdMonth + tenorMonth] - logCompounding[fwdMonth];
+			}
+			SimpleImpliedRateBatch<IMPLIED_RATE_CALCULATOR>::fromLogCompounding(impliedRateCalculator, fwdCurve.data(), (QuantLib::Time)tenorMonth / 12., fwdCurve.data(), n_forwards);
+			for (decltype(n_forwards) fwdMonth = 0; fwdMonth < n_forwards; ++fwdMonth) {
+				fwdCurve[fwdMonth] /= multiplier;
 			}
-			zeroRates[0] = zeroRates[1];
-			return ret;
 		}
 		static std::shared_ptr<MonthlyForwardCurve> forwardCurve(
 			const MonthlyZeroRates& monthlyZeroRates,
 			size_t tenorMonth = 1
 		) {
+			auto n_zeros = monthlyZeroRates.size();
+			QL_REQUIRE(n_zeros >= 2, "too few zero rate nodes (" << n_zeros << "). The minimum is 2");
 			QL_REQUIRE(tenorMonth > 0, "tenor in month (" << tenorMonth << ") must be greater than zero");
-			FwdRateCalculator fwdRateCalculator(monthlyZeroRates);
-			auto n_zeros = monthlyZeroRates.size(); // n_zeros >= 2
-			QL_REQUIRE(tenorMonth < n_zeros, "tenor in month (" << tenorMonth << ") is over the limit (" << (n_zeros-1) << ")");
-			auto n_forwards = n_zeros - tenorMonth;	// n_forwards > 0
-			std::shared_ptr<MonthlyForwardCurve> ret(new MonthlyForwardCurve(n_forwards));
-			auto& monthlyFwdCurve = *ret;
-			for (decltype(n_forwards) fwdMonth = 0; fwdMonth < n_forwards; ++fwdMonth) {
-				monthlyFwdCurve[fwdMonth] = fwdRateCalculator(tenorMonth, fwdMonth);
+			QL_REQUIRE(tenorMonth < n_zeros, "tenor in month (" << tenorMonth << ") is over the limit (" << (n_zeros - 1) << ")");
+			std::vector<QuantLib::Real> logCompoundings;
+			std::shared_ptr<MonthlyForwardCurve> ret(new MonthlyForwardCurve(n_zeros - tenorMonth));
+			forwardCurve(monthlyZeroRates, *ret, tenorMonth, logCompoundings);
+			return ret;
+		}
+		// forward curve from the discount factors of a zero curve already calculated for other calculators (log compounding = -log discount factor)
+		static std::shared_ptr<MonthlyForwardCurve> forwardCurve(
+			const typename FwdRateCalculator::pMonthlyDiscountFactors& discountFactors,
+			size_t tenorMonth = 1
+		) {
+			const auto& logDiscountFactors = discountFactors->logDiscountFactors();
+			auto n_zeros = logDiscountFactors.size(); // n_zeros >= 2
+			std::vector<QuantLib::Real> logCompoundings(n_zeros);
+			for (decltype(n_zeros) month = 0; month < n_zeros; ++month) {
+				logCompoundings[month] = -logDiscountFactors[month];
 			}
+			QL_REQUIRE(tenorMonth > 0, "tenor in month (" << tenorMonth << ") must be greater than zero");
+			QL_REQUIRE(tenorMonth < n_zeros, "tenor in month (" << tenorMonth << ") is over the limit (" << (n_zeros - 1) << ")");
+			std::shared_ptr<MonthlyForwardCurve> ret(new MonthlyForwardCurve(n_zeros - tenorMonth));
+			forwardCurveFromLogCompounding(logCompoundings, *ret, tenorMonth);
 			return ret;
 		}
 	};
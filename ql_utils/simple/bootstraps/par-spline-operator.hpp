@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/simple/span.hpp>
+#include <ql_utils/simple/scenario-matrix.hpp>
+#include <vector>
+#include <algorithm>
+
+namespace QLUtils {
+	// natural cubic spline of par yield nodes evaluated at every month 0..maxMonth (month 0 = month 1), extrapolated before the first node
+	// with the first segment's polynomial, ie: QuantLib::Cubic(CubicInterpolation::Spline, false, SecondDerivative, 0.0, SecondDerivative, 0.0)
+	// as used by SimpleParYieldTSBootstrapper, solved in the caller's workspace
+	struct SimpleMonthlySpline {
+		// work buffers of interpolate(), reused from one call to the next
+		struct Workspace {
+			std::vector<QuantLib::Time> terms;
+			std::vector<double> secondDerivatives;
+			std::vector<double> upperDiagonal;	// of the tridiagonal system, after elimination
+		};
+		// monthly must have maturityMonths.back() + 1 elements
+		static void interpolate(
+			SimpleSpan<const size_t> maturityMonths,
+			SimpleConstRates values,
+			SimpleRates monthly,
+			Workspace& workspace
+		) {
+			auto n = maturityMonths.size();
+			QL_REQUIRE(n == values.size(), "maturities (" << n << ") and values (" << values.size() << ") must have the same length");
+			QL_REQUIRE(n > 0, "par term structure is empty");
+			auto maxMonth = maturityMonths.back();
+			QL_REQUIRE(monthly.size() == maxMonth + 1, "monthly buffer size (" << monthly.size() << ") must be the max maturity month + 1 (" << (maxMonth + 1) << ")");
+			if (n == 1) {	// only one node => cannot spline
+				QL_REQUIRE(maturityMonths[0] == 1, "the only maturity month has to be month 1");
+				monthly[1] = monthly[0] = values[0];
+				return;
+			}
+			auto& x = workspace.terms;
+			auto& m = workspace.secondDerivatives;
+			auto& c = workspace.upperDiagonal;
+			x.resize(n);
+			m.assign(n, 0.);	// natural spline: zero second derivatives at both ends
+			c.resize(n);
+			for (size_t i = 0; i < n; ++i) {
+				QL_REQUIRE(i == 0 || maturityMonths[i] > maturityMonths[i - 1], "maturity months must be strictly increasing");
+				x[i] = (QuantLib::Time)maturityMonths[i] / 12.;
+			}
+			// tridiagonal system of the interior second derivatives, solved by forward elimination (into c and m) and back substitution
+			for (size_t i = 1; i + 1 < n; ++i) {
+				auto h_0 = x[i] - x[i - 1];
+				auto h_1 = x[i + 1] - x[i];
+				auto rhs = 6. * ((values[i + 1] - values[i]) / h_1 - (values[i] - values[i - 1]) / h_0);
+				auto diag = 2. * (h_0 + h_1) - (i > 1 ? h_0 * c[i - 1] : 0.);
+				c[i] = h_1 / diag;
+				m[i] = (rhs - (i > 1 ? h_0 * m[i - 1] : 0.)) / diag;
+			}
+			for (size_t i = n - 2; i >= 1 && i + 1 < n; --i) {
+				m[i] -= c[i] * m[i + 1];
+			}
+			size_t segment = 0;
+			for (decltype(maxMonth) month = 1; month <= maxMonth; ++month) {	// for each consecutive month all the way to maxMonth
+				auto t = (QuantLib::Time)month / 12.;
+				while (segment + 2 < n && t > x[segment + 1]) {
+					++segment;
+				}
+				auto x_0 = x[segment];
+				auto x_1 = x[segment + 1];
+				auto h = x_1 - x_0;
+				auto a = x_1 - t;
+				auto b = t - x_0;
+				monthly[month] = (m[segment] * a * a * a + m[segment + 1] * b * b * b) / (6. * h)
+					+ (values[segment] / h - m[segment] * h / 6.) * a
+					+ (values[segment + 1] / h - m[segment + 1] * h / 6.) * b;
+			}
+			monthly[0] = monthly[1];
+		}
+	};
+
+	// the monthly spline of a fixed par maturity grid as a linear operator: the spline is linear in the node yields, so
+	// monthly[month] = sum over the nodes j of weights[month][j] * parYields[j]. the (maxMonth + 1) x nodes weights are calculated once
+	// per grid, then every respline is a dense mat-vec, or a mat-mat across a batch of scenarios
+	class SimpleParSplineOperator {
+	private:
+		std::vector<size_t> maturityMonths_;
+		QuantLib::Matrix weights_;
+	public:
+		explicit SimpleParSplineOperator(
+			const std::vector<size_t>& maturityMonths	// par node grid, strictly increasing
+		) : maturityMonths_(maturityMonths)
+		{
+			QL_REQUIRE(!maturityMonths.empty(), "par term structure is empty");
+			auto nodes = maturityMonths.size();
+			auto months = maturityMonths.back() + 1;
+			weights_ = QuantLib::Matrix(months, nodes, 0.);
+			SimpleMonthlySpline::Workspace workspace;
+			std::vector<double> unit(nodes, 0.);
+			std::vector<double> column(months);
+			for (size_t j = 0; j < nodes; ++j) {	// spline of each unit node vector
+				unit[j] = 1.;
+				SimpleMonthlySpline::interpolate(maturityMonths_, unit, column, workspace);
+				unit[j] = 0.;
+				for (size_t month = 0; month < months; ++month) {
+					weights_[month][j] = column[month];
+				}
+			}
+		}
+		const std::vector<size_t>& maturityMonths() const {
+			return maturityMonths_;
+		}
+		size_t nodes() const {
+			return maturityMonths_.size();
+		}
+		// months 0..maxMonth
+		size_t months() const {
+			return weights_.rows();
+		}
+		size_t maxMonth() const {
+			return weights_.rows() - 1;
+		}
+		const QuantLib::Matrix& weights() const {
+			return weights_;
+		}
+		// monthly par yields (maxMonth + 1 elements) of the node par yields
+		void apply(
+			SimpleConstRates parYields,
+			SimpleRates monthly
+		) const {
+			auto nodes = this->nodes();
+			QL_REQUIRE(parYields.size() == nodes, "par yields (" << parYields.size() << ") must have one value per node (" << nodes << ")");
+			QL_REQUIRE(monthly.size() == months(), "monthly buffer size (" << monthly.size() << ") must be the max maturity month + 1 (" << months() << ")");
+			for (size_t month = 0; month < months(); ++month) {
+				const auto* w = weights_.row_begin(month);
+				double sum = 0.;
+				for (size_t j = 0; j < nodes; ++j) {
+					sum += w[j] * parYields[j];
+				}
+				monthly[month] = sum;
+			}
+		}
+		// monthly par yields of a batch of scenarios: nodeParYields has one row (SimpleScenarioMatrix month) per node
+		void apply(
+			const SimpleScenarioMatrix& nodeParYields,
+			SimpleScenarioMatrix& monthly
+		) const {
+			auto nodes = this->nodes();
+			auto nScenarios = nodeParYields.scenarios();
+			QL_REQUIRE(nodeParYields.months() == nodes, "par yields (" << nodeParYields.months() << ") must have one row per node (" << nodes << ")");
+			monthly.resize(nScenarios, months());
+			for (size_t month = 0; month < months(); ++month) {
+				const auto* w = weights_.row_begin(month);
+				auto* out = monthly.month(month);
+				std::fill(out, out + nScenarios, 0.);
+				for (size_t j = 0; j < nodes; ++j) {
+					auto weight = w[j];
+					if (weight == 0.) {
+						continue;
+					}
+					const auto* node = nodeParYields.month(j);
+					for (size_t s = 0; s < nScenarios; ++s) {
+						out[s] += weight * node[s];
+					}
+				}
+			}
+		}
+	};
+}
@@ -3,6 +3,9 @@
 #include <ql/quantlib.hpp>
 #include <ql_utils/types.hpp>
 #include <ql_utils/simple/rate-calculators/par-yield-calculator.hpp>
+#include <ql_utils/simple/span.hpp>
+#include <ql_utils/simple/bootstraps/par-spline-operator.hpp>
+#include <ql_utils/utilities/monthly-date-grid.hpp>
 #include <memory>
 #include <vector>
 #include <iostream>
@@ -18,10 +21,21 @@ namespace QLUtils {
 	class SimpleParYieldTSBootstrapper {
 	private:
 		using ParRateCalculator = SimpleParRateCalculator<RATE_UNIT, COUPON_FREQ>;
+		using MonthlyDiscountFactors = typename ParRateCalculator::MonthlyDiscountFactors;
+	public:
+		// how the discount factor of each month past the first year is solved from the par yield
+		enum StrippingMode {
+			FullAnnuity,	// re-sum the annuity over every earlier coupon from the zero rates, O(n^2) pow() calls
+			RunningAnnuity	// keep a running annuity per coupon phase over discount factors calculated once per month, O(n)
+		};
 	private:
 		// input
 		std::vector<size_t> maturityMonths_;
 		std::vector<double> parYields_;
+	public:
+		// input
+		StrippingMode strippingMode;
+		std::shared_ptr<const SimpleParSplineOperator> splineOperator;	// precomputed spline of the maturity grid, shared by the bootstraps on the same grid (the spline is solved on each bootstrap if not set)
 	public:
 		// output
 		std::shared_ptr<std::vector<double>> pMonthlySplinedParYields;
@@ -32,12 +46,137 @@ namespace QLUtils {
 			const std::vector<size_t>& maturityMonths,
 			const std::vector<double>& parYields
 		) : maturityMonths_(maturityMonths),
-			parYields_(parYields)
+			parYields_(parYields),
+			strippingMode(RunningAnnuity)
 		{
 			QL_REQUIRE(maturityMonths.size() == parYields.size(), "maturities vector (" << maturityMonths.size() << ") and par yields vector (" << parYields_.size() << ") must have the same length");
 			QL_REQUIRE(!maturityMonths.empty(), "par term structure is empty");
 		}
 	public:
+		// work buffers of the allocation free bootstrap(), reused from one call to the next
+		struct Workspace {
+			SimpleMonthlySpline::Workspace spline;
+			std::vector<double> splinedParYields;	// par yield of every month 0..maxMonth (month 0 = month 1) after bootstrap()
+			std::vector<double> annuities;
+		};
+		// strip a par yield for every month 0..maxMonth (month 0 = month 1) to zero rates with the running annuity (see RunningAnnuity)
+		// zeroRates must have the same size as parYields. annuities is a work buffer
+		// the discount factors of the first year and the zero rates past it are converted in batch kernel passes around the recurrence,
+		// which only takes multiplies and divides
+		static void stripParYields(
+			SimpleConstRates parYields,
+			SimpleRates zeroRates,
+			std::vector<double>& annuities
+		) {
+			auto n = parYields.size();
+			QL_REQUIRE(n >= 2, "too few par yields (" << n << "). The minimum is 2");
+			QL_REQUIRE(zeroRates.size() == n, "zero rates buffer size (" << zeroRates.size() << ") is not the par yields' size (" << n << ")");
+			auto maxMonth = n - 1;
+			auto multiplier = ParRateCalculator::multiplier();
+			auto freq = ParRateCalculator::couponFrequency();
+			auto cpnIntrvlMonths = ParRateCalculator::couponIntervalMonths();
+			// annuities[i] = sum of dt * df over the months i, i - cpnIntrvlMonths, i - 2 * cpnIntrvlMonths, ... > 0,
+			// so the annuity of all the coupons before the last one of month is annuities[month - cpnIntrvlMonths]
+			annuities.assign(n, 0.);
+			auto accumulate = [&annuities, &cpnIntrvlMonths](const std::size_t& month, QuantLib::DiscountFactor df) {
+				auto dt = (QuantLib::Time)(std::min(cpnIntrvlMonths, month)) / 12.;
+				annuities[month] = dt * df + (month > cpnIntrvlMonths ? annuities[month - cpnIntrvlMonths] : 0.);
+			};
+			auto firstYear = std::min((size_t)12, maxMonth);
+			for (decltype(maxMonth) month = 0; month <= firstYear; ++month) {
+				zeroRates[month] = parYields[month];
+			}
+			// discount factors of the months 1..firstYear into the annuities, each turned into its annuity in place
+			SimpleConstRates firstYearZeroRates(zeroRates.data() + 1, firstYear);
+			SimpleRates firstYearDfs(annuities.data() + 1, firstYear);
+			MonthlyDiscountFactors::logCompoundings(firstYearZeroRates, firstYearDfs, 1);
+			for (auto& df : firstYearDfs) {
+				df = -df;
+			}
+			SimpleMathKernels::exp(firstYearDfs.data(), firstYearDfs.data(), firstYear);
+			for (decltype(maxMonth) month = 1; month <= firstYear; ++month) {
+				accumulate(month, annuities[month]);
+			}
+			if (maxMonth <= 12) {
+				return;
+			}
+			for (decltype(maxMonth) month = 13; month <= maxMonth; ++month) {
+				auto sum = annuities[month - cpnIntrvlMonths];
+				// parYield * sum + (1 + parYield / freq) * dfLast = 1
+				auto parYield = parYields[month] * multiplier;
+				auto df = (1. - parYield * sum) / (1. + parYield / freq);
+				zeroRates[month] = df;	// converted below
+				accumulate(month, df);
+			}
+			auto longZeroRates = zeroRates.subspan(13, maxMonth - 12);
+			SimpleMathKernels::log(longZeroRates.data(), longZeroRates.data(), longZeroRates.size());
+			for (auto& logCompounding : longZeroRates) {	// -log(df)
+				logCompounding = -logCompounding;
+			}
+			MonthlyDiscountFactors::zeroRates(longZeroRates, longZeroRates, 13);
+		}
+		// inverse of stripParYields(): spot par yield of every tenor month 0..n-1 (month 0 = month 1) of the zero rates, as SimpleParRateCalculator
+		// parYields must have the same size as zeroRates. annuities is a work buffer
+		static void monthlyParYields(
+			SimpleConstRates zeroRates,
+			SimpleRates parYields,
+			std::vector<double>& annuities
+		) {
+			auto n = zeroRates.size();
+			QL_REQUIRE(n >= 2, "too few zero rate nodes (" << n << "). The minimum is 2");
+			QL_REQUIRE(parYields.size() == n, "par yields buffer size (" << parYields.size() << ") is not the zero rates' size (" << n << ")");
+			auto cpnIntrvlMonths = ParRateCalculator::couponIntervalMonths();
+			annuities.resize(n);
+			// discount factors by the batch kernels into the annuities, each turned into its annuity in place
+			MonthlyDiscountFactors::logCompoundings(zeroRates, annuities);
+			for (auto& df : annuities) {
+				df = -df;
+			}
+			SimpleMathKernels::exp(annuities.data(), annuities.data(), n);
+			for (decltype(n) tenorMonth = 1; tenorMonth < n; ++tenorMonth) {	// the same recurrence as the batch engine, on a single curve
+				ParRateCalculator::annuityParYields(
+					tenorMonth,
+					annuities.data() + tenorMonth,
+					(tenorMonth > cpnIntrvlMonths ? annuities.data() + (tenorMonth - cpnIntrvlMonths) : nullptr),
+					zeroRates.data() + tenorMonth,
+					annuities.data() + tenorMonth,
+					parYields.data() + tenorMonth,
+					1
+				);
+			}
+			parYields[0] = parYields[1];
+		}
+		// allocation free version of bootstrap() for scenario loops: the par yield nodes are splined with SimpleMonthlySpline
+		// (the same spline as bootstrap()) and stripped with the running annuity into the caller's zeroRates,
+		// which must have maturityMonths.back() + 1 elements. once the workspace is warmed up no heap allocation is performed
+		static void bootstrap(
+			SimpleSpan<const size_t> maturityMonths,
+			SimpleConstRates parYields,
+			SimpleRates zeroRates,
+			Workspace& workspace
+		) {
+			auto n = maturityMonths.size();
+			QL_REQUIRE(n == parYields.size(), "maturities (" << n << ") and par yields (" << parYields.size() << ") must have the same length");
+			QL_REQUIRE(n > 0, "par term structure is empty");
+			auto maxMonth = maturityMonths.back();
+			QL_REQUIRE(zeroRates.size() == maxMonth + 1, "zero rates buffer size (" << zeroRates.size() << ") must be the max maturity month + 1 (" << (maxMonth + 1) << ")");
+			auto& splined = workspace.splinedParYields;
+			splined.resize(maxMonth + 1);
+			SimpleMonthlySpline::interpolate(maturityMonths, parYields, splined, workspace.spline);
+			stripParYields(splined, zeroRates, workspace.annuities);
+		}
+		// allocation free bootstrap() on a fixed par grid, resplined by the grid's precomputed operator (a mat-vec) instead of solving the spline
+		static void bootstrap(
+			const SimpleParSplineOperator& splineOperator,
+			SimpleConstRates parYields,	// one par yield per node of the operator's grid
+			SimpleRates zeroRates,	// splineOperator.maxMonth() + 1 elements
+			Workspace& workspace
+		) {
+			auto& splined = workspace.splinedParYields;
+			splined.resize(splineOperator.months());
+			splineOperator.apply(parYields, splined);
+			stripParYields(splined, zeroRates, workspace.annuities);
+		}
 		void bootstrap(
 			bool buildZeroCurve = false,
 			const QuantLib::Date& curveReferenceDate = QuantLib::Date()
@@ -56,19 +195,25 @@ namespace QLUtils {
 				zeroRates[0] = parYields[0];
 			}
 			else {	// more then 1 node in the par yield term structure
-				std::vector<QuantLib::Time> terms;
-				for (auto const& maturityMonth : maturityMonths_) {	// for each maturity
-					auto term = (QuantLib::Time)maturityMonth / 12.;
-					terms.push_back(term);
-				}
-				QuantLib::Cubic naturalCubicSpline(QuantLib::CubicInterpolation::Spline, false, QuantLib::CubicInterpolation::SecondDerivative, 0.0, QuantLib::CubicInterpolation::SecondDerivative, 0.0);
-				auto parInterp = naturalCubicSpline.interpolate(terms.begin(), terms.end(), parYields_.begin());
 				pMonthlySplinedParYields.reset(new std::vector<double>(maxMonth + 1));
 				auto& parYields = *pMonthlySplinedParYields;
-				for (decltype(maxMonth) month = 1; month <= maxMonth; month++) {	// for each consecutive month all the way to maxMonth
-					auto term = (QuantLib::Time)month / 12.;
-					auto parYield = parInterp(term, true);
-					parYields[month] = parYield;
+				if (splineOperator != nullptr) {	// respline by a mat-vec
+					QL_REQUIRE(splineOperator->maturityMonths() == maturityMonths_, "the spline operator's maturity grid is not the bootstrap's");
+					splineOperator->apply(parYields_, parYields);
+				}
+				else {
+					std::vector<QuantLib::Time> terms;
+					for (auto const& maturityMonth : maturityMonths_) {	// for each maturity
+						auto term = (QuantLib::Time)maturityMonth / 12.;
+						terms.push_back(term);
+					}
+					QuantLib::Cubic naturalCubicSpline(QuantLib::CubicInterpolation::Spline, false, QuantLib::CubicInterpolation::SecondDerivative, 0.0, QuantLib::CubicInterpolation::SecondDerivative, 0.0);
+					auto parInterp = naturalCubicSpline.interpolate(terms.begin(), terms.end(), parYields_.begin());
+					for (decltype(maxMonth) month = 1; month <= maxMonth; month++) {	// for each consecutive month all the way to maxMonth
+						auto term = (QuantLib::Time)month / 12.;
+						auto parYield = parInterp(term, true);
+						parYields[month] = parYield;
+					}
 				}
 				parYields[0] = parYields[1];
 				pMonthlyZeroRates.reset(new std::vector<double>(parYields.size()));
@@ -98,23 +243,28 @@ namespace QLUtils {
 					auto dfLast = rhs / (1. + parYield / freq);
 					return dfLast;
 				};
-				for (decltype(maxMonth) month = 13; month <= maxMonth; ++month) {
-					auto df = solveLastDiscountFactorForPar(month);
-					auto t = (QuantLib::Time)month / 12.;
-					auto zr = (std::pow(1.0 / df, 1.0 / t / freq) - 1.) * freq;
-					zeroRates[month] = zr / multiplier;
+				if (strippingMode == FullAnnuity) {
+					for (decltype(maxMonth) month = 13; month <= maxMonth; ++month) {
+						auto df = solveLastDiscountFactorForPar(month);
+						auto t = (QuantLib::Time)month / 12.;
+						auto zr = (std::pow(1.0 / df, 1.0 / t / freq) - 1.) * freq;
+						zeroRates[month] = zr / multiplier;
+					}
+				}
+				else {	// RunningAnnuity
+					std::vector<double> annuities;
+					stripParYields(parYields, zeroRates, annuities);
 				}
 			}
 			const auto& zeroRates = *pMonthlyZeroRates;
 			if (buildZeroCurve) {
-				std::vector<QuantLib::Date> dates(maxMonth + 1);
 				std::vector<QuantLib::Rate> yields(maxMonth + 1);
 				auto baseReferenceDate = (curveReferenceDate == QuantLib::Date() ? QuantLib::Settings::instance().evaluationDate() : curveReferenceDate);
+				auto dateGrid = MonthlyDateGridCache::instance().grid(baseReferenceDate, maxMonth, QuantLib::Actual365Fixed());	// shared by the curves of the same reference date
 				for (decltype(maxMonth) month = 0; month <= maxMonth; ++month) {
-					dates[month] = baseReferenceDate + month * QuantLib::Months;
 					yields[month] = zeroRates[month] * multiplier;
 				}
-				pZeroCurve.reset(new QuantLib::InterpolatedZeroCurve<QuantLib::Linear>(dates, yields, QuantLib::Actual365Fixed(), QuantLib::Linear(), QuantLib::Compounded, COUPON_FREQ));
+				pZeroCurve.reset(new QuantLib::InterpolatedZeroCurve<QuantLib::Linear>(dateGrid->dates(), yields, dateGrid->dayCounter(), QuantLib::Linear(), QuantLib::Compounded, COUPON_FREQ));
 			}
 		}
 
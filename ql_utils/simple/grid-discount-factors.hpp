@@ -0,0 +1,197 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/simple/span.hpp>
+#include <ql_utils/simple/math-kernels.hpp>
+#include <memory>
+#include <vector>
+#include <cmath>
+
+namespace QLUtils {
+	// year fraction of a grid period, grid time is t = index / periodsPerYear(), ie: Actual/365 Fixed for the day and week grids and
+	// month / 12 for the month grid (the same time as the monthly classes)
+	template <
+		QuantLib::TimeUnit GRID_UNIT
+	>
+	struct SimpleGridUnit;
+
+	template <>
+	struct SimpleGridUnit<QuantLib::Days> {
+		static double periodsPerYear() {
+			return 365.;
+		}
+	};
+
+	template <>
+	struct SimpleGridUnit<QuantLib::Weeks> {
+		static double periodsPerYear() {
+			return 365. / 7.;
+		}
+	};
+
+	template <>
+	struct SimpleGridUnit<QuantLib::Months> {
+		static double periodsPerYear() {
+			return 12.;
+		}
+	};
+
+	// discount factors and log discount factors of every point of a day/week/month grid of zero rates, calculated once
+	// index i is i grid periods from the reference date, so a query is an O(1) lookup into the precomputed vectors instead of
+	// a YieldTermStructure virtual call and interpolation. the month grid is SimpleMonthlyDiscountFactors
+	template <
+		QuantLib::TimeUnit GRID_UNIT = QuantLib::Days,
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	class SimpleGridDiscountFactors {
+	private:
+		GridZeroRates zeroRates_;	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: index=0)
+		std::vector<QuantLib::DiscountFactor> discountFactors_;
+		std::vector<QuantLib::Real> logDiscountFactors_;
+	public:
+		SimpleGridDiscountFactors(
+			const GridZeroRates& zeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: index=0)
+		) : zeroRates_(zeroRates)
+		{
+			auto n = zeroRates.size();
+			QL_REQUIRE(n >= 2, "too few zero rate nodes (" << n << "). The minimum is 2");
+			discountFactors_.resize(n);
+			logDiscountFactors_.resize(n);
+			logCompoundings(zeroRates, logDiscountFactors_);
+			for (auto& logDiscountFactor : logDiscountFactors_) {
+				logDiscountFactor = -logDiscountFactor;
+			}
+			SimpleMathKernels::exp(logDiscountFactors_.data(), discountFactors_.data(), n);
+		}
+		// zero rates of the grid points 0..lastIndex sampled once from a term structure (index 0 set to index 1), in RATE_UNIT
+		// and compounded in COUPON_FREQ, the input of the constructor. the term structure is sampled at the dates of the grid points
+		// (reference date + i grid periods) and the discount factors are turned into zero rates with the grid's own time(i),
+		// so the grid reproduces the term structure's discount factors whatever its day counter
+		static std::shared_ptr<GridZeroRates> sampleZeroRates(
+			const QuantLib::YieldTermStructure& termStructure,
+			size_t lastIndex
+		) {
+			QL_REQUIRE(lastIndex >= 1, "last grid index (" << lastIndex << ") must be at least 1");
+			std::shared_ptr<GridZeroRates> ret(new GridZeroRates(lastIndex + 1));
+			auto& sampled = *ret;
+			auto referenceDate = termStructure.referenceDate();
+			for (size_t i = 1; i <= lastIndex; ++i) {	// log compoundings first, converted below
+				sampled[i] = -std::log(termStructure.discount(referenceDate + QuantLib::Period((QuantLib::Integer)i, GRID_UNIT), true));
+			}
+			SimpleRates logCompoundings(sampled.data() + 1, lastIndex);
+			zeroRates(logCompoundings, logCompoundings, 1);
+			sampled[0] = sampled[1];
+			return ret;
+		}
+		// batch compounding of grid zero rates by the SimpleMathKernels, element i being the grid index firstIndex + i:
+		// logCompoundings[i] = t * freq * log(1 + zr / freq) = -log(df), with t = time(index) (may be the same memory)
+		static void logCompoundings(
+			SimpleConstRates zeroRates,
+			SimpleRates logCompoundings,
+			size_t firstIndex = 0
+		) {
+			auto n = zeroRates.size();
+			QL_REQUIRE(logCompoundings.size() == n, "log compoundings buffer size (" << logCompoundings.size() << ") must be the zero rates' size (" << n << ")");
+			auto freq = couponFrequency();
+			auto scale = multiplier() / freq;
+			for (decltype(n) i = 0; i < n; ++i) {
+				logCompoundings[i] = zeroRates[i] * scale;
+			}
+			SimpleMathKernels::log1p(logCompoundings.data(), logCompoundings.data(), n);
+			for (decltype(n) i = 0; i < n; ++i) {
+				logCompoundings[i] = time(firstIndex + i) * freq * logCompoundings[i];
+			}
+		}
+		// inverse of logCompoundings(): zeroRates[i] = (exp(logCompoundings[i] / (t * freq)) - 1) * freq of the grid index firstIndex + i > 0
+		// (may be the same memory)
+		static void zeroRates(
+			SimpleConstRates logCompoundings,
+			SimpleRates zeroRates,
+			size_t firstIndex = 1
+		) {
+			auto n = logCompoundings.size();
+			QL_REQUIRE(firstIndex > 0, "grid index 0 has no compounding to imply a zero rate from");
+			QL_REQUIRE(zeroRates.size() == n, "zero rates buffer size (" << zeroRates.size() << ") must be the log compoundings' size (" << n << ")");
+			auto freq = couponFrequency();
+			for (decltype(n) i = 0; i < n; ++i) {
+				zeroRates[i] = logCompoundings[i] / (time(firstIndex + i) * freq);
+			}
+			SimpleMathKernels::expm1(zeroRates.data(), zeroRates.data(), n);
+			auto scale = freq / multiplier();
+			for (decltype(n) i = 0; i < n; ++i) {
+				zeroRates[i] *= scale;
+			}
+		}
+		static double multiplier() {
+			auto unit = RATE_UNIT;
+			switch (unit) {
+			case RateUnit::Decimal:
+			default:
+				return 1.;
+			case RateUnit::Percent:
+				return 0.01;
+			case RateUnit::BasisPoint:
+				return 0.0001;
+			}
+		}
+		static double couponFrequency() {
+			return (double)COUPON_FREQ;
+		}
+		static size_t couponIntervalMonths() {
+			return (size_t)12 / (size_t)COUPON_FREQ;
+		}
+		static QuantLib::TimeUnit gridUnit() {
+			return GRID_UNIT;
+		}
+		static double periodsPerYear() {
+			return SimpleGridUnit<GRID_UNIT>::periodsPerYear();
+		}
+		// year fraction of the grid index
+		static QuantLib::Time time(
+			size_t index
+		) {
+			return (QuantLib::Time)index / periodsPerYear();
+		}
+		const GridZeroRates& zeroRates() const {
+			return zeroRates_;
+		}
+		size_t size() const {
+			return discountFactors_.size();
+		}
+		size_t lastIndex() const {
+			return discountFactors_.size() - 1;
+		}
+		const std::vector<QuantLib::DiscountFactor>& discountFactors() const {
+			return discountFactors_;
+		}
+		const std::vector<QuantLib::Real>& logDiscountFactors() const {
+			return logDiscountFactors_;
+		}
+		QuantLib::DiscountFactor discount(
+			size_t index
+		) const {
+			return discountFactors_[index];
+		}
+		QuantLib::Real logDiscount(
+			size_t index
+		) const {
+			return logDiscountFactors_[index];
+		}
+		// discount factor from fwdIndex to index
+		QuantLib::DiscountFactor forwardDiscount(
+			size_t fwdIndex,
+			size_t index
+		) const {
+			return discountFactors_[index] / discountFactors_[fwdIndex];
+		}
+	};
+
+	template <
+		QuantLib::TimeUnit GRID_UNIT = QuantLib::Days,
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	using pSimpleGridDiscountFactors = std::shared_ptr<const SimpleGridDiscountFactors<GRID_UNIT, RATE_UNIT, COUPON_FREQ>>;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/simple/grid-discount-factors.hpp>
+#include <memory>
+#include <vector>
+
+namespace QLUtils {
+	// base of the rate calculators on a day/week/month grid of zero rates. SimpleRateCalculator derives from its month grid
+	template <
+		QuantLib::TimeUnit GRID_UNIT = QuantLib::Days,
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	class SimpleGridRateCalculator {
+	public:
+		typedef SimpleGridDiscountFactors<GRID_UNIT, RATE_UNIT, COUPON_FREQ> GridDiscountFactors;
+		typedef pSimpleGridDiscountFactors<GRID_UNIT, RATE_UNIT, COUPON_FREQ> pGridDiscountFactors;
+	protected:
+		pGridDiscountFactors discountFactors_;
+		const GridZeroRates& zeroRates_;	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: index=0)
+	protected:
+		SimpleGridRateCalculator(
+			const GridZeroRates& zeroRates
+		): discountFactors_(new GridDiscountFactors(zeroRates)),
+			zeroRates_(discountFactors_->zeroRates())
+		{}
+		SimpleGridRateCalculator(
+			const pGridDiscountFactors& discountFactors	// shared with other calculators on the same curve
+		): discountFactors_(discountFactors),
+			zeroRates_(discountFactors->zeroRates())
+		{}
+		void checkForwardBounds(
+			size_t tenor,
+			size_t fwdIndex
+		) const {
+			QL_REQUIRE(tenor > 0, "tenor in grid periods (" << tenor << ") must be greater than zero");
+			auto n_zeros = zeroRates_.size();
+			auto lastRelevantIndex = fwdIndex + tenor;
+			QL_REQUIRE(lastRelevantIndex < n_zeros, "forward+tenor (" << (lastRelevantIndex) << ") is over the limit (" << (n_zeros - 1) << ")");
+		}
+	public:
+		const GridZeroRates& zeroRates() const {
+			return zeroRates_;
+		}
+		const GridDiscountFactors& discountFactors() const {
+			return *discountFactors_;
+		}
+		const pGridDiscountFactors& sharedDiscountFactors() const {
+			return discountFactors_;
+		}
+		static double multiplier() {
+			return GridDiscountFactors::multiplier();
+		}
+		static double couponFrequency() {
+			return GridDiscountFactors::couponFrequency();
+		}
+		static QuantLib::Time time(
+			size_t index
+		) {
+			return GridDiscountFactors::time(index);
+		}
+		// spot discount factor of the grid index, an O(1) lookup
+		QuantLib::DiscountFactor discount(
+			size_t index
+		) const {
+			QL_REQUIRE(index < zeroRates_.size(), "grid index (" << index << ") is over the limit (" << (zeroRates_.size() - 1) << ")");
+			return discountFactors_->discount(index);
+		}
+	};
+}
@@ -0,0 +1,487 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/simple/span.hpp>
+#include <vector>
+#include <atomic>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+// the vector kernels use the GCC/Clang vector extensions compiled for AVX2 and AVX-512 through target attributes
+// and are selected at runtime from the CPU features, other compilers/platforms get the scalar kernels only
+#if !defined(QLUTILS_SIMPLE_NO_SIMD_KERNELS) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define QLUTILS_SIMPLE_SIMD_KERNELS
+#endif
+
+namespace QLUtils {
+	// instruction set of the batch math kernels
+	enum SimpleKernelIsa {
+		ScalarKernels = 0,	// std::log1p/std::expm1/std::exp... one element at a time
+		Avx2Kernels = 1,	// 4 doubles at a time
+		Avx512Kernels = 2	// 8 doubles at a time
+	};
+
+	inline std::ostream& operator << (std::ostream& os, SimpleKernelIsa isa) {
+		switch (isa) {
+		case Avx2Kernels:
+			return os << "AVX2";
+		case Avx512Kernels:
+			return os << "AVX-512";
+		default:
+			return os << "Scalar";
+		}
+	}
+
+#ifdef QLUTILS_SIMPLE_SIMD_KERNELS
+	namespace SimpleKernelsDetail {
+		typedef double Real4 __attribute__((vector_size(32)));
+		typedef std::int64_t Int4 __attribute__((vector_size(32)));
+		typedef double Real8 __attribute__((vector_size(64)));
+		typedef std::int64_t Int8 __attribute__((vector_size(64)));
+		typedef std::uint64_t UInt4 __attribute__((vector_size(32)));
+		typedef std::uint64_t UInt8 __attribute__((vector_size(64)));
+
+		// generic vector code on vectors of W doubles, always inlined in the target specific functions below
+		// (the vectors are passed by reference, the generic code being compiled without the target's vector ABI)
+		// the masks are made from the sign of integer differences of the IEEE bit patterns rather than by vector comparisons,
+		// which some compilers scalarize when the target has no instruction to turn a comparison mask into a vector
+		template <
+			typename REAL,
+			typename INT,
+			typename UINT,
+			size_t W
+		>
+		struct Pack {
+			typedef REAL Real;
+			typedef INT Int;
+			typedef UINT UInt;
+			static constexpr size_t width = W;
+			__attribute__((always_inline)) static void load(Real& v, const double* p) {
+				std::memcpy(&v, p, sizeof(v));
+			}
+			__attribute__((always_inline)) static void store(double* p, const Real& v) {
+				std::memcpy(p, &v, sizeof(v));
+			}
+			// mask lanes are all ones or all zeros
+			__attribute__((always_inline)) static void select(Real& out, const Int& mask, const Real& a, const Real& b) {
+				out = (Real)((mask & (Int)a) | (~mask & (Int)b));
+			}
+			// all ones on the lanes where a < b, for bit patterns a and b (as unsigned integers) with |a - b| < 2^63
+			__attribute__((always_inline)) static void less(Int& mask, const Int& a, const Int& b) {
+				auto difference = (Int)((UInt)a - (UInt)b);
+				if constexpr (W == 4) {	// AVX2 has a 64 bit comparison but no 64 bit arithmetic shift
+					mask = (difference < 0);
+				}
+				else {
+					mask = difference >> 63;
+				}
+			}
+			// any lane non zero
+			__attribute__((always_inline)) static bool any(const Int& mask) {
+				std::int64_t lanes[W];
+				std::memcpy(lanes, &mask, sizeof(mask));
+				std::int64_t any = 0;
+				for (size_t i = 0; i < W; ++i) {
+					any |= lanes[i];
+				}
+				return any != 0;
+			}
+		};
+		typedef Pack<Real4, Int4, UInt4, 4> Pack4;
+		typedef Pack<Real8, Int8, UInt8, 8> Pack8;
+
+		const double shifter = 6755399441055744.0;	// 1.5 * 2^52: the low bits of the mantissa of x + shifter are round(x) for |x| < 2^51
+
+		// log(u) + c / u for u in [DBL_MIN, inf), c being the rounding error of u (fdlibm's log, with log1p's correction term)
+		template <
+			typename P
+		>
+		__attribute__((always_inline)) inline void log(typename P::Real& out, const typename P::Real& u, const typename P::Real& c) {
+			typedef typename P::Real Real;
+			typedef typename P::Int Int;
+			auto bits = (Int)u;
+			auto e = ((bits >> 52) & 0x7ff) - 1023;
+			auto m = (Real)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);	// [1, 2)
+			Int high;
+			P::less(high, Int{} + 0x3ff6a09e667f3bcdLL, (Int)m);	// reduce m to [sqrt(2)/2, sqrt(2))
+			P::select(m, high, m * 0.5, m);
+			e = e - high;	// high is -1 on the lanes to adjust
+			auto k = (Real)(e + (Int)(Real{} + shifter)) - shifter;
+			auto f = m - 1.;
+			auto s = f / (2. + f);
+			auto z = s * s;
+			auto w = z * z;
+			auto t_1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+			auto t_2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+			auto r = t_2 + t_1;
+			auto hfsq = 0.5 * f * f;
+			out = k * 6.93147180369123816490e-01 - ((hfsq - (s * (hfsq + r) + (k * 1.90821492927058770002e-10 + c / u))) - f);
+		}
+
+		// exp(x) - 1 or exp(x) for |x| < 708: x = k * ln2 + r, |r| <= ln2 / 2, expm1(r) by its Taylor series, 2^k by the exponent bits
+		template <
+			typename P,
+			bool MINUS_ONE
+		>
+		__attribute__((always_inline)) inline void exp(typename P::Real& out, const typename P::Real& x) {
+			typedef typename P::Real Real;
+			typedef typename P::Int Int;
+			auto k = (x * 1.44269504088896338700e+00 + shifter) - shifter;	// round to nearest
+			auto r = (x - k * 6.93147180369123816490e-01) - k * 1.90821492927058770002e-10;
+			auto p = 1. / 87178291200. + r * (1. / 1307674368000.);
+			p = 1. / 6227020800. + r * p;
+			p = 1. / 479001600. + r * p;
+			p = 1. / 39916800. + r * p;
+			p = 1. / 3628800. + r * p;
+			p = 1. / 362880. + r * p;
+			p = 1. / 40320. + r * p;
+			p = 1. / 5040. + r * p;
+			p = 1. / 720. + r * p;
+			p = 1. / 120. + r * p;
+			p = 1. / 24. + r * p;
+			p = 1. / 6. + r * p;
+			p = 0.5 + r * p;
+			p = r + r * r * p;	// expm1(r)
+			auto bits = (Int)(k + shifter) - (Int)(Real{} + shifter);
+			auto scale = (Real)((bits + 1023) << 52);	// 2^k
+			out = (MINUS_ONE ? (scale - 1.) + scale * p : scale + scale * p);
+		}
+
+		enum Function {
+			Log1p,
+			Log,
+			Exp,
+			Expm1
+		};
+
+		template <
+			Function F
+		>
+		inline double scalar(double x) {
+			switch (F) {
+			case Log1p:
+				return std::log1p(x);
+			case Log:
+				return std::log(x);
+			case Exp:
+				return std::exp(x);
+			default:
+				return std::expm1(x);
+			}
+		}
+
+		// y = F(x) by blocks of P::width, the blocks with an argument outside of the kernels' domain (nan, inf, domain edges)
+		// being calculated by the scalar function
+		template <
+			typename P,
+			Function F
+		>
+		__attribute__((always_inline)) inline void loop(const double* x, double* y, size_t n) {
+			typedef typename P::Real Real;
+			typedef typename P::Int Int;
+			constexpr size_t W = P::width;
+			const Int minLog = Int{} + 0x0010000000000000LL;	// smallest normal
+			const Int infinity = Int{} + 0x7ff0000000000000LL;
+			const Int maxExp = Int{} + 0x4086200000000000LL;	// 708
+			const Int absMask = Int{} + 0x7fffffffffffffffLL;
+			size_t i = 0;
+			for (; i + W <= n; i += W) {
+				Real v, out;
+				Int outside, belowMin, belowInf;
+				P::load(v, x + i);
+				switch (F) {
+				case Log1p: {
+					auto u = 1. + v;
+					P::less(belowMin, (Int)u, minLog);	// including the negative numbers
+					P::less(belowInf, (Int)u, infinity);
+					outside = belowMin | ~belowInf;
+					Int belowTwo;
+					P::less(belowTwo, (Int)u, Int{} + 0x4000000000000000LL);
+					Real c;
+					P::select(c, belowTwo, v - (u - 1.), 1. - (u - v));	// rounding error of u
+					log<P>(out, u, c);
+					break;
+				}
+				case Log:
+					P::less(belowMin, (Int)v, minLog);
+					P::less(belowInf, (Int)v, infinity);
+					outside = belowMin | ~belowInf;
+					log<P>(out, v, Real{});
+					break;
+				default:
+					P::less(belowInf, (Int)v & absMask, maxExp);	// nan included
+					outside = ~belowInf;
+					exp<P, F == Expm1>(out, v);
+					break;
+				}
+				if (P::any(outside)) {
+					for (size_t j = i; j < i + W; ++j) {
+						y[j] = scalar<F>(x[j]);
+					}
+				}
+				else {
+					P::store(y + i, out);
+				}
+			}
+			for (; i < n; ++i) {
+				y[i] = scalar<F>(x[i]);
+			}
+		}
+
+		__attribute__((target("avx2,fma"))) inline void log1pAvx2(const double* x, double* y, size_t n) {
+			loop<Pack4, Log1p>(x, y, n);
+		}
+		__attribute__((target("avx2,fma"))) inline void logAvx2(const double* x, double* y, size_t n) {
+			loop<Pack4, Log>(x, y, n);
+		}
+		__attribute__((target("avx2,fma"))) inline void expAvx2(const double* x, double* y, size_t n) {
+			loop<Pack4, Exp>(x, y, n);
+		}
+		__attribute__((target("avx2,fma"))) inline void expm1Avx2(const double* x, double* y, size_t n) {
+			loop<Pack4, Expm1>(x, y, n);
+		}
+		__attribute__((target("avx512f,avx512dq"))) inline void log1pAvx512(const double* x, double* y, size_t n) {
+			loop<Pack8, Log1p>(x, y, n);
+		}
+		__attribute__((target("avx512f,avx512dq"))) inline void logAvx512(const double* x, double* y, size_t n) {
+			loop<Pack8, Log>(x, y, n);
+		}
+		__attribute__((target("avx512f,avx512dq"))) inline void expAvx512(const double* x, double* y, size_t n) {
+			loop<Pack8, Exp>(x, y, n);
+		}
+		__attribute__((target("avx512f,avx512dq"))) inline void expm1Avx512(const double* x, double* y, size_t n) {
+			loop<Pack8, Expm1>(x, y, n);
+		}
+	}
+#endif
+
+	// batch math kernels of the simple curve classes: y[i] = f(x[i]) over arrays (x and y may be the same memory)
+	// the widest instruction set supported by the CPU is detected once and used by every call, setIsa() can force a narrower one for the process
+	// and IsaScope for the calling thread only. each kernel also takes the instruction set explicitly
+	// the vector kernels are within 2 ulp of the std:: functions; arguments outside of their domain (log of non positive numbers,
+	// overflowing exponentials, nan and inf) are handed to the std:: functions, so the special values are the same
+	struct SimpleMathKernels {
+	private:
+		static std::atomic<int>& currentIsa() {
+			static std::atomic<int> isa((int)detectedIsa());
+			return isa;
+		}
+		static int& threadIsa() {	// -1 if the calling thread follows currentIsa()
+			static thread_local int isa = -1;
+			return isa;
+		}
+	public:
+		// widest instruction set supported by both the build and the CPU
+		static SimpleKernelIsa detectedIsa() {
+#ifdef QLUTILS_SIMPLE_SIMD_KERNELS
+			static const SimpleKernelIsa detected = []() {
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+					return Avx512Kernels;
+				}
+				if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+					return Avx2Kernels;
+				}
+				return ScalarKernels;
+			}();
+			return detected;
+#else
+			return ScalarKernels;
+#endif
+		}
+		// instruction set of the calling thread
+		static SimpleKernelIsa isa() {
+			auto forced = threadIsa();
+			return (SimpleKernelIsa)(forced >= 0 ? forced : currentIsa().load(std::memory_order_relaxed));
+		}
+		// force the instruction set (e.g. ScalarKernels for reproducibility), capped at detectedIsa(). returns the one in use
+		static SimpleKernelIsa setIsa(SimpleKernelIsa isa) {
+			auto used = std::min(isa, detectedIsa());
+			currentIsa() = (int)used;
+			return used;
+		}
+		// forces the instruction set (capped at detectedIsa()) of the kernels called by the calling thread and restores it when it goes
+		// out of scope. unlike setIsa(), the other threads keep their kernels, so the calculators can be compared scalar vs vectorized
+		// while other pricers are running
+		class IsaScope {
+		private:
+			int previous_;
+		public:
+			explicit IsaScope(
+				SimpleKernelIsa isa
+			) : previous_(threadIsa()) {
+				threadIsa() = (int)std::min(isa, detectedIsa());
+			}
+			~IsaScope() {
+				threadIsa() = previous_;
+			}
+			IsaScope(const IsaScope&) = delete;
+			IsaScope& operator = (const IsaScope&) = delete;
+		};
+		// y = log(1 + x) with the given instruction set (capped at detectedIsa())
+		static void log1p(const double* x, double* y, size_t n, SimpleKernelIsa isa) {
+#ifdef QLUTILS_SIMPLE_SIMD_KERNELS
+			switch (std::min(isa, detectedIsa())) {
+			case Avx512Kernels:
+				SimpleKernelsDetail::log1pAvx512(x, y, n);
+				return;
+			case Avx2Kernels:
+				SimpleKernelsDetail::log1pAvx2(x, y, n);
+				return;
+			default:
+				break;
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) {
+				y[i] = std::log1p(x[i]);
+			}
+		}
+		// y = log(1 + x) with the instruction set of the calling thread
+		static void log1p(const double* x, double* y, size_t n) {
+			log1p(x, y, n, isa());
+		}
+		// y = log(x) with the given instruction set (capped at detectedIsa())
+		static void log(const double* x, double* y, size_t n, SimpleKernelIsa isa) {
+#ifdef QLUTILS_SIMPLE_SIMD_KERNELS
+			switch (std::min(isa, detectedIsa())) {
+			case Avx512Kernels:
+				SimpleKernelsDetail::logAvx512(x, y, n);
+				return;
+			case Avx2Kernels:
+				SimpleKernelsDetail::logAvx2(x, y, n);
+				return;
+			default:
+				break;
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) {
+				y[i] = std::log(x[i]);
+			}
+		}
+		// y = log(x) with the instruction set of the calling thread
+		static void log(const double* x, double* y, size_t n) {
+			log(x, y, n, isa());
+		}
+		// y = exp(x) with the given instruction set (capped at detectedIsa())
+		static void exp(const double* x, double* y, size_t n, SimpleKernelIsa isa) {
+#ifdef QLUTILS_SIMPLE_SIMD_KERNELS
+			switch (std::min(isa, detectedIsa())) {
+			case Avx512Kernels:
+				SimpleKernelsDetail::expAvx512(x, y, n);
+				return;
+			case Avx2Kernels:
+				SimpleKernelsDetail::expAvx2(x, y, n);
+				return;
+			default:
+				break;
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) {
+				y[i] = std::exp(x[i]);
+			}
+		}
+		// y = exp(x) with the instruction set of the calling thread
+		static void exp(const double* x, double* y, size_t n) {
+			exp(x, y, n, isa());
+		}
+		// y = exp(x) - 1 with the given instruction set (capped at detectedIsa())
+		static void expm1(const double* x, double* y, size_t n, SimpleKernelIsa isa) {
+#ifdef QLUTILS_SIMPLE_SIMD_KERNELS
+			switch (std::min(isa, detectedIsa())) {
+			case Avx512Kernels:
+				SimpleKernelsDetail::expm1Avx512(x, y, n);
+				return;
+			case Avx2Kernels:
+				SimpleKernelsDetail::expm1Avx2(x, y, n);
+				return;
+			default:
+				break;
+			}
+#endif
+			for (size_t i = 0; i < n; ++i) {
+				y[i] = std::expm1(x[i]);
+			}
+		}
+		// y = exp(x) - 1 with the instruction set of the calling thread
+		static void expm1(const double* x, double* y, size_t n) {
+			expm1(x, y, n, isa());
+		}
+		static void log1p(SimpleConstRates x, SimpleRates y) {
+			QL_REQUIRE(x.size() == y.size(), "kernel input (" << x.size() << ") and output (" << y.size() << ") must have the same size");
+			log1p(x.data(), y.data(), x.size());
+		}
+		static void log(SimpleConstRates x, SimpleRates y) {
+			QL_REQUIRE(x.size() == y.size(), "kernel input (" << x.size() << ") and output (" << y.size() << ") must have the same size");
+			log(x.data(), y.data(), x.size());
+		}
+		static void exp(SimpleConstRates x, SimpleRates y) {
+			QL_REQUIRE(x.size() == y.size(), "kernel input (" << x.size() << ") and output (" << y.size() << ") must have the same size");
+			exp(x.data(), y.data(), x.size());
+		}
+		static void expm1(SimpleConstRates x, SimpleRates y) {
+			QL_REQUIRE(x.size() == y.size(), "kernel input (" << x.size() << ") and output (" << y.size() << ") must have the same size");
+			expm1(x.data(), y.data(), x.size());
+		}
+		// check every available instruction set against the std:: functions over the range of the curve calculations
+		// (compoundings of rates from -99% to 1000%, discount factors, exponents of +/-50) and the domain edges, returns the max relative error
+		// (tests/simple-kernels-test.cpp checks the curve calculators themselves against the pow() based reference)
+		static QuantLib::Real verify(
+			std::ostream& os,
+			std::streamsize precision = 16
+		) {
+			std::vector<double> x;
+			for (int i = -990; i <= 10000; ++i) {
+				x.push_back(i / 1000. + 1. / 7.);
+			}
+			for (int i = -300; i <= 300; ++i) {	// small arguments
+				x.push_back(std::ldexp(i % 2 == 0 ? 1.2345 : -1.2345, -std::abs(i) / 6));
+			}
+			for (int i = 0; i < 1000; ++i) {	// exponent range
+				x.push_back(-50. + i * 0.1003);
+			}
+			double special[] = {0., -0., -1., -2., 1000., -1000., 709.5, -745.5, 1e-310, std::nan(""), INFINITY, -INFINITY};
+			x.insert(x.end(), std::begin(special), std::end(special));
+			auto n = x.size();
+			std::vector<double> y(n);
+			os << std::scientific << std::setprecision(precision);
+			QuantLib::Real maxErr = 0.;
+			auto relativeError = [](double actual, double expected) -> double {
+				if (std::isnan(expected)) {
+					return (std::isnan(actual) ? 0. : INFINITY);
+				}
+				if (std::isinf(expected) || expected == 0.) {
+					return (actual == expected ? 0. : INFINITY);
+				}
+				return std::fabs(actual - expected) / std::fabs(expected);
+			};
+			for (int i = (int)ScalarKernels; i <= (int)detectedIsa(); ++i) {
+				auto kernelIsa = (SimpleKernelIsa)i;	// passed to the kernels, the process wide instruction set is left alone
+				QuantLib::Real errs[4] = {0., 0., 0., 0.};
+				log1p(x.data(), y.data(), n, kernelIsa);
+				for (size_t j = 0; j < n; ++j) {
+					errs[0] = std::max(errs[0], relativeError(y[j], std::log1p(x[j])));
+				}
+				log(x.data(), y.data(), n, kernelIsa);
+				for (size_t j = 0; j < n; ++j) {
+					errs[1] = std::max(errs[1], relativeError(y[j], std::log(x[j])));
+				}
+				exp(x.data(), y.data(), n, kernelIsa);
+				for (size_t j = 0; j < n; ++j) {
+					errs[2] = std::max(errs[2], relativeError(y[j], std::exp(x[j])));
+				}
+				expm1(x.data(), y.data(), n, kernelIsa);
+				for (size_t j = 0; j < n; ++j) {
+					errs[3] = std::max(errs[3], relativeError(y[j], std::expm1(x[j])));
+				}
+				os << kernelIsa << ": log1p=" << errs[0] << ", log=" << errs[1] << ", exp=" << errs[2] << ", expm1=" << errs[3] << std::endl;
+				maxErr = std::max(maxErr, *std::max_element(errs, errs + 4));
+			}
+			os << "max relative error=" << maxErr << std::endl;
+			return maxErr;
+		}
+	};
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/simple/grid-discount-factors.hpp>
+#include <memory>
+
+namespace QLUtils {
+	// discount factors and log discount factors of every month of a monthly zero rate vector, calculated once
+	// build it once per zero rate vector and share it (std::shared_ptr) between the simple rate calculators, so repeated par/forward
+	// queries against the same curve are a few multiplies each instead of pow() calls
+	// it is the month grid of SimpleGridDiscountFactors: month m is the grid index m, at time m / 12
+	template <
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	using SimpleMonthlyDiscountFactors = SimpleGridDiscountFactors<QuantLib::Months, RATE_UNIT, COUPON_FREQ>;
+
+	template <
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	using pSimpleMonthlyDiscountFactors = pSimpleGridDiscountFactors<QuantLib::Months, RATE_UNIT, COUPON_FREQ>;
+}
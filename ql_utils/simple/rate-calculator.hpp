@@ -2,53 +2,54 @@
 
 #include <ql/quantlib.hpp>
 #include <ql_utils/types.hpp>
+#include <ql_utils/simple/monthly-discount-factors.hpp>
+#include <ql_utils/simple/grid-rate-calculator.hpp>
+#include <memory>
+#include <vector>
 
 namespace QLUtils {
+	// the month grid of SimpleGridRateCalculator, with the month names of the monthly calculators
 	template <
 		RateUnit RATE_UNIT = RateUnit::Percent,
 		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
 	>
-	class SimpleRateCalculator {
-	protected:
-		const MonthlyZeroRates& monthlyZeroRates_;	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
+	class SimpleRateCalculator:
+		public SimpleGridRateCalculator<QuantLib::Months, RATE_UNIT, COUPON_FREQ> {
+	public:
+		typedef SimpleMonthlyDiscountFactors<RATE_UNIT, COUPON_FREQ> MonthlyDiscountFactors;
+		typedef pSimpleMonthlyDiscountFactors<RATE_UNIT, COUPON_FREQ> pMonthlyDiscountFactors;
 	protected:
 		SimpleRateCalculator(
-			const MonthlyZeroRates& monthlyZeroRates
-		): monthlyZeroRates_(monthlyZeroRates)
-		{
-			auto n = monthlyZeroRates.size();
-			QL_REQUIRE(n >= 2, "too few zero rate nodes (" << n << "). The minimum is 2");
-		}
-		void checkForwardBounds(
-			size_t tenorMonth,
-			size_t fwdMonth
-		) const {
-			QL_REQUIRE(tenorMonth > 0, "tenor in month (" << tenorMonth << ") must be greater than zero");
-			auto n_zeros = monthlyZeroRates_.size();
-			auto lastRelevantMonth = fwdMonth + tenorMonth;
-			QL_REQUIRE(lastRelevantMonth < n_zeros, "forward+tenor (" << (lastRelevantMonth) << ") is over the limit (" << (n_zeros - 1) << ")");
-		}
+			const MonthlyZeroRates& monthlyZeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
+		): SimpleGridRateCalculator<QuantLib::Months, RATE_UNIT, COUPON_FREQ>(monthlyZeroRates) {}
+		SimpleRateCalculator(
+			const pMonthlyDiscountFactors& discountFactors	// shared with other calculators on the same curve
+		): SimpleGridRateCalculator<QuantLib::Months, RATE_UNIT, COUPON_FREQ>(discountFactors) {}
 	public:
 		const MonthlyZeroRates& monthlyZeroRates() const {
-			return monthlyZeroRates_;
-		}
-		static double multiplier() {
-			auto unit = RATE_UNIT;
-			switch (unit) {
-			case RateUnit::Decimal:
-			default:
-				return 1.;
-			case RateUnit::Percent:
-				return 0.01;
-			case RateUnit::BasisPoint:
-				return 0.0001;
-			}
-		}
-		static double couponFrequency() {
-			return (double)COUPON_FREQ;
+			return this->zeroRates();
 		}
 		static size_t couponIntervalMonths() {
-			return (size_t)12 / (size_t)COUPON_FREQ;
+			return MonthlyDiscountFactors::couponIntervalMonths();
 		}
 	};
-}
\ No newline at end of file
+
+	// base class of the grid calculators: SimpleRateCalculator on the month grid, so that the monthly calculators are the month
+	// instantiations of the grid calculators and keep their month API
+	template <
+		QuantLib::TimeUnit GRID_UNIT,
+		RateUnit RATE_UNIT,
+		QuantLib::Frequency COUPON_FREQ
+	>
+	struct SimpleGridRateCalculatorBase {
+		typedef SimpleGridRateCalculator<GRID_UNIT, RATE_UNIT, COUPON_FREQ> type;
+	};
+
+	template <
+		RateUnit RATE_UNIT,
+		QuantLib::Frequency COUPON_FREQ
+	>
+	struct SimpleGridRateCalculatorBase<QuantLib::Months, RATE_UNIT, COUPON_FREQ> {
+		typedef SimpleRateCalculator<RATE_UNIT, COUPON_FREQ> type;
+	};
+}
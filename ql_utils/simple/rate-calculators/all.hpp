@@ -1,4 +1,5 @@
 #pragma once
 
 #include <ql_utils/simple/rate-calculators/fwd-rate-calculator.hpp>
-#include <ql_utils/simple/rate-calculators/par-yield-calculator.hpp>
\ No newline at end of file
+#include <ql_utils/simple/rate-calculators/par-yield-calculator.hpp>
+#include <ql_utils/simple/rate-calculators/grid-fwd-rate-calculator.hpp>
\ No newline at end of file
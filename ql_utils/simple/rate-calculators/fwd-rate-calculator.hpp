@@ -2,45 +2,20 @@
 
 #include <ql/quantlib.hpp>
 #include <ql_utils/types.hpp>
-#include <ql_utils/simple/rate-calculator.hpp>
+#include <ql_utils/simple/rate-calculators/grid-fwd-rate-calculator.hpp>
+#include <ql_utils/simple/math-kernels.hpp>
 #include <cmath>
 
 namespace QLUtils {
 	// calculate spot/forward rate give a monthly zero rates vector, compounded in some frequency
+	// the month grid of SimpleGridForwardRateCalculator, tenor and forward start in months
 	template <
 		typename IMPLIED_RATE_CALCULATOR,
 		RateUnit RATE_UNIT = RateUnit::Percent,
 		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
 	>
-	class SimpleForwardRateCalculator:
-		public SimpleRateCalculator<RATE_UNIT, COUPON_FREQ> {
-	private:
-		IMPLIED_RATE_CALCULATOR impliedRateCalculator_;
-	public:
-		SimpleForwardRateCalculator(
-			const MonthlyZeroRates& monthlyZeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
-		): SimpleRateCalculator<RATE_UNIT, COUPON_FREQ>(monthlyZeroRates) {}
-		double operator() (
-			size_t tenorMonth,
-			size_t fwdMonth = 0
-		) const {
-			this->checkForwardBounds(tenorMonth, fwdMonth);
-			auto freq = this->couponFrequency();	// zero rate's compounding frequency
-			auto multiplier = this->multiplier();
-			const auto& monthlyZeroRates = this->monthlyZeroRates();
-			auto lastRelevantMonth = fwdMonth + tenorMonth;
-			auto t_0 = (QuantLib::Time)fwdMonth / 12.;
-			QuantLib::Rate zr_0 = monthlyZeroRates[fwdMonth] * multiplier;
-			QuantLib::DiscountFactor df_0 = std::pow(1. + zr_0 / freq, -t_0 * freq);
-			auto t_1 = (QuantLib::Time)lastRelevantMonth / 12.;
-			QuantLib::Rate zr_1 = monthlyZeroRates[lastRelevantMonth] * multiplier;
-			QuantLib::DiscountFactor df_1 = std::pow(1. + zr_1 / freq, -t_1 * freq);
-			QuantLib::Real compounding = df_0 / df_1;
-			auto dt = t_1 - t_0;
-			QuantLib::Rate r = impliedRateCalculator_(compounding, dt);
-			return r / multiplier;
-		}
-	};
+	using SimpleForwardRateCalculator = SimpleGridForwardRateCalculator<IMPLIED_RATE_CALCULATOR, QuantLib::Months, RATE_UNIT, COUPON_FREQ>;
+
 	// implied simple rate calculator
 	struct NominalSimpleImpliedRateCalculator {
 		QuantLib::Rate operator() (
@@ -55,6 +30,53 @@ namespace QLUtils {
 		) const {
 			return (1. + r * t);
 		}
+		// log of compounding() and its inverse, for the log-space conversions
+		QuantLib::Real logCompounding(
+			QuantLib::Rate r,
+			QuantLib::Time t
+		) const {
+			return std::log1p(r * t);
+		}
+		QuantLib::Rate fromLogCompounding(
+			QuantLib::Real logCompounding,
+			QuantLib::Time t
+		) const {
+			return std::expm1(logCompounding) / t;
+		}
+		// batch versions over n elements by the SimpleMathKernels, at one time or a time per element (out may be the input)
+		void logCompounding(
+			const QuantLib::Rate* r,
+			QuantLib::Time t,
+			QuantLib::Real* out,
+			size_t n
+		) const {
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = r[i] * t;
+			}
+			SimpleMathKernels::log1p(out, out, n);
+		}
+		void fromLogCompounding(
+			const QuantLib::Real* logCompounding,
+			QuantLib::Time t,
+			QuantLib::Rate* out,
+			size_t n
+		) const {
+			SimpleMathKernels::expm1(logCompounding, out, n);
+			for (size_t i = 0; i < n; ++i) {
+				out[i] /= t;
+			}
+		}
+		void fromLogCompounding(
+			const QuantLib::Real* logCompounding,
+			const QuantLib::Time* t,
+			QuantLib::Rate* out,
+			size_t n
+		) const {
+			SimpleMathKernels::expm1(logCompounding, out, n);
+			for (size_t i = 0; i < n; ++i) {
+				out[i] /= t[i];
+			}
+		}
 	};
 	// implied continuously-compounded rate calculator
 	struct NominalContinuouslyCompoundedImpliedRateCalculator {
@@ -70,6 +92,49 @@ namespace QLUtils {
 		) const {
 			return std::exp(r * t);
 		}
+		QuantLib::Real logCompounding(
+			QuantLib::Rate r,
+			QuantLib::Time t
+		) const {
+			return r * t;
+		}
+		QuantLib::Rate fromLogCompounding(
+			QuantLib::Real logCompounding,
+			QuantLib::Time t
+		) const {
+			return logCompounding / t;
+		}
+		// batch versions over n elements, at one time or a time per element (out may be the input)
+		void logCompounding(
+			const QuantLib::Rate* r,
+			QuantLib::Time t,
+			QuantLib::Real* out,
+			size_t n
+		) const {
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = r[i] * t;
+			}
+		}
+		void fromLogCompounding(
+			const QuantLib::Real* logCompounding,
+			QuantLib::Time t,
+			QuantLib::Rate* out,
+			size_t n
+		) const {
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = logCompounding[i] / t;
+			}
+		}
+		void fromLogCompounding(
+			const QuantLib::Real* logCompounding,
+			const QuantLib::Time* t,
+			QuantLib::Rate* out,
+			size_t n
+		) const {
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = logCompounding[i] / t[i];
+			}
+		}
 	};
 	// implied compounded rate calculator
 	template <
@@ -90,5 +155,65 @@ namespace QLUtils {
 			auto frequency = (QuantLib::Real)COMPOUNDING_FREQ;
 			return std::pow(1. + r/frequency, t * frequency);
 		}
+		QuantLib::Real logCompounding(
+			QuantLib::Rate r,
+			QuantLib::Time t
+		) const {
+			auto frequency = (QuantLib::Real)COMPOUNDING_FREQ;
+			return t * frequency * std::log1p(r / frequency);
+		}
+		QuantLib::Rate fromLogCompounding(
+			QuantLib::Real logCompounding,
+			QuantLib::Time t
+		) const {
+			auto frequency = (QuantLib::Real)COMPOUNDING_FREQ;
+			return std::expm1(logCompounding / (t * frequency)) * frequency;
+		}
+		// batch versions over n elements by the SimpleMathKernels, at one time or a time per element (out may be the input)
+		void logCompounding(
+			const QuantLib::Rate* r,
+			QuantLib::Time t,
+			QuantLib::Real* out,
+			size_t n
+		) const {
+			auto frequency = (QuantLib::Real)COMPOUNDING_FREQ;
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = r[i] / frequency;
+			}
+			SimpleMathKernels::log1p(out, out, n);
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = t * frequency * out[i];
+			}
+		}
+		void fromLogCompounding(
+			const QuantLib::Real* logCompounding,
+			QuantLib::Time t,
+			QuantLib::Rate* out,
+			size_t n
+		) const {
+			auto frequency = (QuantLib::Real)COMPOUNDING_FREQ;
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = logCompounding[i] / (t * frequency);
+			}
+			SimpleMathKernels::expm1(out, out, n);
+			for (size_t i = 0; i < n; ++i) {
+				out[i] *= frequency;
+			}
+		}
+		void fromLogCompounding(
+			const QuantLib::Real* logCompounding,
+			const QuantLib::Time* t,
+			QuantLib::Rate* out,
+			size_t n
+		) const {
+			auto frequency = (QuantLib::Real)COMPOUNDING_FREQ;
+			for (size_t i = 0; i < n; ++i) {
+				out[i] = logCompounding[i] / (t[i] * frequency);
+			}
+			SimpleMathKernels::expm1(out, out, n);
+			for (size_t i = 0; i < n; ++i) {
+				out[i] *= frequency;
+			}
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/simple/rate-calculator.hpp>
+#include <ql_utils/simple/math-kernels.hpp>
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <type_traits>
+
+namespace QLUtils {
+	// batch log-space conversions of an implied rate calculator over n elements (out may be the input)
+	// an IMPLIED_RATE_CALCULATOR only has to provide operator() (compounding, t) and compounding(r, t). the batch members
+	// logCompounding(const Rate*, Time, Real*, size_t) and fromLogCompounding(const Real*, Time or const Time*, Rate*, size_t)
+	// are an optional extension (see NominalSimpleImpliedRateCalculator), used when the calculator has them. otherwise the
+	// conversions fall back to the scalar members, element by element
+	template <
+		typename IMPLIED_RATE_CALCULATOR
+	>
+	class SimpleImpliedRateBatch {
+	private:
+		template <typename C>
+		static auto detectLogCompounding(int) -> decltype(std::declval<const C&>().logCompounding((const QuantLib::Rate*)nullptr, QuantLib::Time(), (QuantLib::Real*)nullptr, size_t()), std::true_type());
+		template <typename C>
+		static std::false_type detectLogCompounding(...);
+		template <typename C, typename TIME>
+		static auto detectFromLogCompounding(int) -> decltype(std::declval<const C&>().fromLogCompounding((const QuantLib::Real*)nullptr, std::declval<TIME>(), (QuantLib::Rate*)nullptr, size_t()), std::true_type());
+		template <typename C, typename TIME>
+		static std::false_type detectFromLogCompounding(...);
+	public:
+		static constexpr bool hasBatchLogCompounding = decltype(detectLogCompounding<IMPLIED_RATE_CALCULATOR>(0))::value;
+		static constexpr bool hasBatchFromLogCompounding = decltype(detectFromLogCompounding<IMPLIED_RATE_CALCULATOR, QuantLib::Time>(0))::value;
+		static constexpr bool hasBatchFromLogCompoundingTimes = decltype(detectFromLogCompounding<IMPLIED_RATE_CALCULATOR, const QuantLib::Time*>(0))::value;
+	private:
+		SimpleImpliedRateBatch() {}
+	public:
+		// out[i] = log(compounding(r[i], t))
+		static void logCompounding(
+			const IMPLIED_RATE_CALCULATOR& impliedRateCalculator,
+			const QuantLib::Rate* r,
+			QuantLib::Time t,
+			QuantLib::Real* out,
+			size_t n
+		) {
+			if constexpr (hasBatchLogCompounding) {
+				impliedRateCalculator.logCompounding(r, t, out, n);
+			}
+			else {
+				for (size_t i = 0; i < n; ++i) {
+					out[i] = std::log(impliedRateCalculator.compounding(r[i], t));
+				}
+			}
+		}
+		// out[i] = impliedRateCalculator(exp(logCompounding[i]), t)
+		static void fromLogCompounding(
+			const IMPLIED_RATE_CALCULATOR& impliedRateCalculator,
+			const QuantLib::Real* logCompounding,
+			QuantLib::Time t,
+			QuantLib::Rate* out,
+			size_t n
+		) {
+			if constexpr (hasBatchFromLogCompounding) {
+				impliedRateCalculator.fromLogCompounding(logCompounding, t, out, n);
+			}
+			else {
+				for (size_t i = 0; i < n; ++i) {
+					out[i] = impliedRateCalculator(std::exp(logCompounding[i]), t);
+				}
+			}
+		}
+		// out[i] = impliedRateCalculator(exp(logCompounding[i]), t[i])
+		static void fromLogCompounding(
+			const IMPLIED_RATE_CALCULATOR& impliedRateCalculator,
+			const QuantLib::Real* logCompounding,
+			const QuantLib::Time* t,
+			QuantLib::Rate* out,
+			size_t n
+		) {
+			if constexpr (hasBatchFromLogCompoundingTimes) {
+				impliedRateCalculator.fromLogCompounding(logCompounding, t, out, n);
+			}
+			else {
+				for (size_t i = 0; i < n; ++i) {
+					out[i] = impliedRateCalculator(std::exp(logCompounding[i]), t[i]);
+				}
+			}
+		}
+	};
+
+	// calculate spot/forward rate given the zero rates of a day/week/month grid, compounded in some frequency
+	// tenor and forward start are in grid periods (eg: days for a bill on the day grid). SimpleForwardRateCalculator is the month grid
+	template <
+		typename IMPLIED_RATE_CALCULATOR,
+		QuantLib::TimeUnit GRID_UNIT = QuantLib::Days,
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	class SimpleGridForwardRateCalculator:
+		public SimpleGridRateCalculatorBase<GRID_UNIT, RATE_UNIT, COUPON_FREQ>::type {
+	private:
+		typedef typename SimpleGridRateCalculatorBase<GRID_UNIT, RATE_UNIT, COUPON_FREQ>::type BaseCalculator;
+		IMPLIED_RATE_CALCULATOR impliedRateCalculator_;
+	public:
+		SimpleGridForwardRateCalculator(
+			const GridZeroRates& zeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: index=0)
+		): BaseCalculator(zeroRates) {}
+		SimpleGridForwardRateCalculator(
+			const typename BaseCalculator::pGridDiscountFactors& discountFactors	// shared with other calculators on the same curve
+		): BaseCalculator(discountFactors) {}
+		double operator() (
+			size_t tenor,
+			size_t fwdIndex = 0
+		) const {
+			this->checkForwardBounds(tenor, fwdIndex);
+			auto multiplier = this->multiplier();
+			auto lastRelevantIndex = fwdIndex + tenor;
+			const auto& discountFactors = this->discountFactors();
+			QuantLib::Real compounding = discountFactors.discount(fwdIndex) / discountFactors.discount(lastRelevantIndex);
+			auto dt = this->time(tenor);
+			QuantLib::Rate r = impliedRateCalculator_(compounding, dt);
+			return r / multiplier;
+		}
+		// fills rates[fwdIndex][tenor - 1] with (*this)(tenor, fwdIndex) for every fwdIndex < rates.rows() and tenor <= rates.columns()
+		// from the curve's log discount factors, a row at a time through SimpleImpliedRateBatch::fromLogCompounding()
+		// cells past the end of the curve (fwdIndex + tenor > last index) are set to Null<Real>()
+		void grid(
+			QuantLib::Matrix& rates
+		) const {
+			auto multiplier = this->multiplier();
+			const auto& logDfs = this->discountFactors().logDiscountFactors();
+			auto lastIndex = logDfs.size() - 1;
+			std::vector<QuantLib::Time> times(rates.columns());	// times[tenor - 1] = time(tenor)
+			for (size_t tenor = 1; tenor <= rates.columns(); ++tenor) {
+				times[tenor - 1] = this->time(tenor);
+			}
+			for (size_t fwdIndex = 0; fwdIndex < rates.rows(); ++fwdIndex) {
+				auto row = rates.row_begin(fwdIndex);
+				size_t n = 0;	// number of cells of the row within the curve
+				for (size_t tenor = 1; tenor <= rates.columns(); ++tenor) {
+					auto lastRelevantIndex = fwdIndex + tenor;
+					if (lastRelevantIndex > lastIndex) {
+						row[tenor - 1] = QuantLib::Null<QuantLib::Real>();
+						continue;
+					}
+					row[tenor - 1] = logDfs[fwdIndex] - logDfs[lastRelevantIndex];	// log compounding
+					++n;
+				}
+				SimpleImpliedRateBatch<IMPLIED_RATE_CALCULATOR>::fromLogCompounding(impliedRateCalculator_, &row[0], times.data(), &row[0], n);
+				for (size_t i = 0; i < n; ++i) {
+					row[i] /= multiplier;
+				}
+			}
+		}
+	};
+}
@@ -4,6 +4,7 @@
 #include <ql_utils/types.hpp>
 #include <ql_utils/simple/rate-calculator.hpp>
 #include <algorithm>
+#include <vector>
 #include <cmath>
 
 namespace QLUtils {
@@ -18,31 +19,28 @@ namespace QLUtils {
 		SimpleParRateCalculator(
 			const MonthlyZeroRates& monthlyZeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
 		): SimpleRateCalculator<RATE_UNIT, COUPON_FREQ>(monthlyZeroRates) {}
+		SimpleParRateCalculator(
+			const typename SimpleRateCalculator<RATE_UNIT, COUPON_FREQ>::pMonthlyDiscountFactors& discountFactors	// shared with other calculators on the same curve
+		): SimpleRateCalculator<RATE_UNIT, COUPON_FREQ>(discountFactors) {}
 		double operator() (
 			size_t tenorMonth,
 			size_t fwdMonth = 0
 		) const {
 			this->checkForwardBounds(tenorMonth, fwdMonth);
-			auto freq = this->couponFrequency();
 			auto multiplier = this->multiplier();
 			const auto& monthlyZeroRates = this->monthlyZeroRates();
+			const auto& discountFactors = this->discountFactors();
 			auto lastRelevantMonth = fwdMonth + tenorMonth;
-			auto t_0 = (QuantLib::Time)fwdMonth / 12.;
-			auto zr_0 = monthlyZeroRates[fwdMonth] * multiplier;
-			auto df_0 = std::pow(1.0 + zr_0 / freq, -t_0 * freq);
+			auto df_0 = discountFactors.discount(fwdMonth);
 			if (tenorMonth <= 12) {
 				if (fwdMonth == 0) {
 					return monthlyZeroRates[tenorMonth];
 				}
-				else {
-					auto month = lastRelevantMonth;
-					auto zr = monthlyZeroRates[month] * multiplier;
-					auto t = (QuantLib::Time)month / 12.;
-					auto df = std::pow(1.0 + zr / freq, -t * freq);
-					df /= df_0;
-					t = (QuantLib::Time)tenorMonth / 12.;
-					zr = (std::pow(df, -1. / (t * freq)) - 1.0) * freq;
-					return zr / multiplier;
+				else {	// forward zero rate from the log compounding, converted by the kernels like grid() does
+					QuantLib::Real zr = discountFactors.logDiscount(fwdMonth) - discountFactors.logDiscount(lastRelevantMonth);
+					SimpleRates zeroRates(&zr, 1);
+					SimpleMonthlyDiscountFactors<RATE_UNIT, COUPON_FREQ>::zeroRates(zeroRates, zeroRates, tenorMonth);
+					return zr;
 				}
 			}
 			else { // tenorMonth > 12
@@ -54,10 +52,7 @@ namespace QLUtils {
 				for (auto month = start; month <= lastRelevantMonth; month += cpnIntrvlMonths) {
 					auto d_months = month - prevMonth;
 					auto dt = (QuantLib::Time)d_months / 12.;
-					auto zr = monthlyZeroRates[month] * multiplier;
-					auto t = (QuantLib::Time)month / 12.;
-					auto df = std::pow(1.0 + zr / freq, -t * freq);
-					df /= df_0;
+					auto df = discountFactors.discount(month) / df_0;
 					sum += dt * df;
 					prevMonth = month;
 					last_df = df;
@@ -66,5 +61,91 @@ namespace QLUtils {
 				return r / multiplier;
 			}
 		}
+		// one tenor month of the zero to par recurrence across count curves (scenarios), shared by the single curve and the batch par yields:
+		// annuities[s] = dt * dfs[s] + prevAnnuities[s], prevAnnuities being the annuities of tenorMonth - couponIntervalMonths() (nullptr if none),
+		// and parYields[s] = (1 - dfs[s]) / annuities[s], or the zero rate itself within the first year. dfs may be the same memory as annuities
+		static void annuityParYields(
+			size_t tenorMonth,
+			const double* dfs,
+			const double* prevAnnuities,
+			const double* zeroRates,
+			double* annuities,
+			double* parYields,
+			size_t count
+		) {
+			auto dt = (QuantLib::Time)(std::min(SimpleParRateCalculator::couponIntervalMonths(), tenorMonth)) / 12.;
+			if (tenorMonth <= 12) {
+				if (prevAnnuities == nullptr) {
+					for (size_t s = 0; s < count; ++s) {
+						annuities[s] = dt * dfs[s];
+					}
+				}
+				else {
+					for (size_t s = 0; s < count; ++s) {
+						annuities[s] = dt * dfs[s] + prevAnnuities[s];
+					}
+				}
+				std::copy(zeroRates, zeroRates + count, parYields);
+				return;
+			}
+			QL_ASSERT(prevAnnuities != nullptr, "tenor month " << tenorMonth << " has no previous coupon annuity");
+			auto mult = SimpleParRateCalculator::multiplier();
+			for (size_t s = 0; s < count; ++s) {
+				auto df = dfs[s];
+				auto annuity = dt * df + prevAnnuities[s];
+				annuities[s] = annuity;
+				parYields[s] = (1. - df) / annuity / mult;
+			}
+		}
+		// fills rates[fwdMonth][tenorMonth - 1] with (*this)(tenorMonth, fwdMonth) for every fwdMonth < rates.rows() and tenorMonth <= rates.columns()
+		// from the curve's discount factors and a running annuity per coupon phase, so each cell costs O(1) instead of O(tenor) pow() calls
+		// the forward zero rates of the first year are converted from the log discount factors a row at a time by the batch kernels
+		// cells past the end of the curve (fwdMonth + tenorMonth > last month) are set to Null<Real>()
+		void grid(
+			QuantLib::Matrix& rates
+		) const {
+			auto multiplier = this->multiplier();
+			auto cpnIntrvlMonths = this->couponIntervalMonths();
+			const auto& monthlyZeroRates = this->monthlyZeroRates();
+			const auto& dfs = this->discountFactors().discountFactors();
+			const auto& logDfs = this->discountFactors().logDiscountFactors();
+			auto lastMonth = dfs.size() - 1;
+			std::vector<double> annuities(rates.columns() + 1);	// annuities[j] = sum of (cpnIntrvlMonths / 12) * df over the months fwdMonth + j, fwdMonth + j - cpnIntrvlMonths, ... > fwdMonth
+			for (size_t fwdMonth = 0; fwdMonth < rates.rows(); ++fwdMonth) {
+				auto row = rates.row_begin(fwdMonth);
+				auto df_0 = dfs[std::min(fwdMonth, lastMonth)];
+				size_t firstYear = 0;	// number of forward zero rate cells of the row (tenorMonth <= 12) within the curve
+				for (size_t tenorMonth = 1; tenorMonth <= rates.columns(); ++tenorMonth) {
+					auto lastRelevantMonth = fwdMonth + tenorMonth;
+					if (lastRelevantMonth > lastMonth) {
+						row[tenorMonth - 1] = QuantLib::Null<QuantLib::Real>();
+						continue;
+					}
+					auto df = dfs[lastRelevantMonth];
+					annuities[tenorMonth] = (QuantLib::Time)cpnIntrvlMonths / 12. * df + (tenorMonth > cpnIntrvlMonths ? annuities[tenorMonth - cpnIntrvlMonths] : 0.);
+					if (tenorMonth <= 12) {
+						if (fwdMonth == 0) {
+							row[tenorMonth - 1] = monthlyZeroRates[tenorMonth];
+						}
+						else {
+							row[tenorMonth - 1] = logDfs[fwdMonth] - logDfs[lastRelevantMonth];	// log compounding, converted below
+							++firstYear;
+						}
+					}
+					else {	// tenorMonth > 12
+						// the first coupon period is the stub of start months, the others are full coupon intervals
+						auto start = (tenorMonth % cpnIntrvlMonths == 0 ? cpnIntrvlMonths : tenorMonth % cpnIntrvlMonths);
+						auto df_start = dfs[fwdMonth + start];
+						auto sum = annuities[tenorMonth] - annuities[start] + (QuantLib::Time)start / 12. * df_start;
+						auto r = (df_0 - df) / sum;
+						row[tenorMonth - 1] = r / multiplier;
+					}
+				}
+				if (firstYear > 0) {
+					SimpleRates zeroRates(&row[0], firstYear);
+					SimpleMonthlyDiscountFactors<RATE_UNIT, COUPON_FREQ>::zeroRates(zeroRates, zeroRates, 1);
+				}
+			}
+		}
 	};
 }
\ No newline at end of file
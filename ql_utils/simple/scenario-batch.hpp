@@ -0,0 +1,273 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/simple/monthly-discount-factors.hpp>
+#include <ql_utils/simple/math-kernels.hpp>
+#include <ql_utils/simple/ts-shock.hpp>
+#include <ql_utils/simple/scenario-matrix.hpp>
+#include <ql_utils/simple/rate-calculators/fwd-rate-calculator.hpp>
+#include <ql_utils/simple/rate-calculators/par-yield-calculator.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace QLUtils {
+	// the monthly simple curve stack (SimpleRateCalculator, SimpleForwardZeroConverter, SimpleParYieldTSBootstrapper,
+	// SimpleParShockTS, SimpleMonthlyForwardShockTS) run on a whole batch of scenarios at once
+	// every calculation is a pass over the months with an inner loop across the scenarios of a SimpleScenarioMatrix, without any
+	// per scenario objects or allocations, so the compiler can vectorize the inner loops and the batch is limited by memory bandwidth
+	// the zero rates are compounded in COUPON_FREQ, in the unit of RATE_UNIT, month 0 being the spot zero rate, as for the single curve classes
+	template <
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	class SimpleScenarioBatchEngine {
+	public:
+		typedef SimpleMonthlyDiscountFactors<RATE_UNIT, COUPON_FREQ> MonthlyDiscountFactors;
+	private:
+		SimpleScenarioMatrix discountFactors_;
+		SimpleScenarioMatrix annuities_;
+		SimpleScenarioMatrix rates_;
+		std::vector<double> shocks_;
+	private:
+		static void checkZeroRates(const SimpleScenarioMatrix& zeroRates) {
+			QL_REQUIRE(zeroRates.months() >= 2, "too few zero rate nodes (" << zeroRates.months() << "). The minimum is 2");
+		}
+		// shock of every month in decimal
+		void monthlyShocks(
+			size_t months,
+			size_t firstMonth,
+			const SimpleMonthlyShockProc& monthlyShocker
+		) {
+			shocks_.resize(months);
+			for (size_t m = firstMonth; m < months; ++m) {
+				shocks_[m] = monthlyShocker(m);
+			}
+		}
+	public:
+		static double multiplier() {
+			return MonthlyDiscountFactors::multiplier();
+		}
+		static double couponFrequency() {
+			return MonthlyDiscountFactors::couponFrequency();
+		}
+		static size_t couponIntervalMonths() {
+			return MonthlyDiscountFactors::couponIntervalMonths();
+		}
+		// discount factors of every month of every scenario, a month at a time by the batch kernels
+		static void discountFactors(
+			const SimpleScenarioMatrix& zeroRates,
+			SimpleScenarioMatrix& discountFactors
+		) {
+			checkZeroRates(zeroRates);
+			auto freq = couponFrequency();
+			auto mult = multiplier();
+			auto n = zeroRates.months();
+			auto nScenarios = zeroRates.scenarios();
+			discountFactors.resize(nScenarios, n);
+			for (size_t m = 0; m < n; ++m) {
+				auto t = (QuantLib::Time)m / 12.;
+				const auto* zr = zeroRates.month(m);
+				auto* df = discountFactors.month(m);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					df[s] = zr[s] * mult / freq;
+				}
+				SimpleMathKernels::log1p(df, df, nScenarios);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					df[s] = -t * freq * df[s];
+				}
+				SimpleMathKernels::exp(df, df, nScenarios);
+			}
+		}
+		// spot par yields of every tenor month, in the unit of RATE_UNIT. like SimpleParShockTS's par yields, with month 0 set to month 1
+		void parYields(
+			const SimpleScenarioMatrix& zeroRates,
+			SimpleScenarioMatrix& parYields
+		) {
+			discountFactors(zeroRates, discountFactors_);
+			auto cpnIntrvlMonths = couponIntervalMonths();
+			auto n = zeroRates.months();
+			auto nScenarios = zeroRates.scenarios();
+			parYields.resize(nScenarios, n);
+			annuities_.resize(nScenarios, n);
+			for (size_t m = 1; m < n; ++m) {	// annuities[m] = sum of dt * df over the coupon months m, m - cpnIntrvlMonths, ... > 0
+				SimpleParRateCalculator<RATE_UNIT, COUPON_FREQ>::annuityParYields(
+					m,
+					discountFactors_.month(m),
+					(m > cpnIntrvlMonths ? annuities_.month(m - cpnIntrvlMonths) : nullptr),
+					zeroRates.month(m),
+					annuities_.month(m),
+					parYields.month(m),
+					nScenarios
+				);
+			}
+			std::copy(parYields.month(1), parYields.month(1) + nScenarios, parYields.month(0));
+		}
+		// strip monthly spot par yields (every tenor month, month 0 ignored) to zero rates, as SimpleParYieldTSBootstrapper does
+		// with a par yield for every month, with its running annuity
+		void zeroRatesFromParYields(
+			const SimpleScenarioMatrix& parYields,
+			SimpleScenarioMatrix& zeroRates
+		) {
+			checkZeroRates(parYields);
+			auto freq = couponFrequency();
+			auto mult = multiplier();
+			auto cpnIntrvlMonths = couponIntervalMonths();
+			auto n = parYields.months();
+			auto nScenarios = parYields.scenarios();
+			zeroRates.resize(nScenarios, n);
+			annuities_.resize(nScenarios, n);
+			for (size_t m = 1; m < n; ++m) {
+				auto t = (QuantLib::Time)m / 12.;
+				auto dt = (QuantLib::Time)(std::min(cpnIntrvlMonths, m)) / 12.;
+				const auto* par = parYields.month(m);
+				const auto* prevAnnuity = (m > cpnIntrvlMonths ? annuities_.month(m - cpnIntrvlMonths) : nullptr);
+				auto* annuity = annuities_.month(m);
+				auto* zr = zeroRates.month(m);
+				if (m <= 12) {	// the discount factors are built in the annuities and turned into the annuities in place
+					for (size_t s = 0; s < nScenarios; ++s) {
+						zr[s] = par[s];
+						annuity[s] = par[s] * mult / freq;
+					}
+					SimpleMathKernels::log1p(annuity, annuity, nScenarios);
+					for (size_t s = 0; s < nScenarios; ++s) {
+						annuity[s] = -t * freq * annuity[s];
+					}
+					SimpleMathKernels::exp(annuity, annuity, nScenarios);
+					for (size_t s = 0; s < nScenarios; ++s) {
+						annuity[s] = dt * annuity[s] + (prevAnnuity == nullptr ? 0. : prevAnnuity[s]);
+					}
+				}
+				else {	// the discount factors are kept in the zero rates and converted in place
+					for (size_t s = 0; s < nScenarios; ++s) {
+						auto parYield = par[s] * mult;
+						auto df = (1. - parYield * prevAnnuity[s]) / (1. + parYield / freq);
+						zr[s] = df;
+						annuity[s] = dt * df + prevAnnuity[s];
+					}
+					SimpleMathKernels::log(zr, zr, nScenarios);
+					for (size_t s = 0; s < nScenarios; ++s) {
+						zr[s] = -zr[s] / (t * freq);
+					}
+					SimpleMathKernels::expm1(zr, zr, nScenarios);
+					for (size_t s = 0; s < nScenarios; ++s) {
+						zr[s] = zr[s] * freq / mult;
+					}
+				}
+			}
+			std::copy(zeroRates.month(1), zeroRates.month(1) + nScenarios, zeroRates.month(0));
+		}
+		// forward rates of the given tenor for every forward month, like SimpleForwardZeroConverter::forwardCurve()
+		template <
+			typename IMPLIED_RATE_CALCULATOR = NominalSimpleImpliedRateCalculator
+		>
+		void forwardCurves(
+			const SimpleScenarioMatrix& zeroRates,
+			SimpleScenarioMatrix& forwardCurves,
+			size_t tenorMonth = 1
+		) {
+			IMPLIED_RATE_CALCULATOR impliedRateCalculator;
+			discountFactors(zeroRates, discountFactors_);
+			auto mult = multiplier();
+			auto n = zeroRates.months();
+			auto nScenarios = zeroRates.scenarios();
+			QL_REQUIRE(tenorMonth > 0, "tenor in month (" << tenorMonth << ") must be greater than zero");
+			QL_REQUIRE(tenorMonth < n, "tenor in month (" << tenorMonth << ") is over the limit (" << (n - 1) << ")");
+			auto nForwards = n - tenorMonth;
+			forwardCurves.resize(nScenarios, nForwards);
+			for (size_t f = 0; f < nForwards; ++f) {
+				auto dt = (QuantLib::Time)(f + tenorMonth) / 12. - (QuantLib::Time)f / 12.;
+				const auto* df_0 = discountFactors_.month(f);
+				const auto* df_1 = discountFactors_.month(f + tenorMonth);
+				auto* fwd = forwardCurves.month(f);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					fwd[s] = impliedRateCalculator(df_0[s] / df_1[s], dt) / mult;
+				}
+			}
+		}
+		// zero rates from monthly (1 month tenor) forward curves, like SimpleForwardZeroConverter::bootstrap()
+		template <
+			typename IMPLIED_RATE_CALCULATOR = NominalSimpleImpliedRateCalculator
+		>
+		void zeroRatesFromForwardCurves(
+			const SimpleScenarioMatrix& forwardCurves,
+			SimpleScenarioMatrix& zeroRates
+		) {
+			IMPLIED_RATE_CALCULATOR impliedRateCalculator;
+			auto freq = couponFrequency();
+			auto mult = multiplier();
+			auto nForwards = forwardCurves.months();
+			auto nScenarios = forwardCurves.scenarios();
+			QL_REQUIRE(nForwards > 0, "forward curve is empty");
+			auto n = nForwards + 1;
+			zeroRates.resize(nScenarios, n);
+			rates_.resize(nScenarios, 1);	// running log compounding from month 0
+			auto* logCompounding = rates_.month(0);
+			std::fill(logCompounding, logCompounding + nScenarios, 0.);
+			for (size_t m = 0; m < nForwards; ++m) {
+				auto t_1 = (QuantLib::Time)(m + 1) / 12.;
+				const auto* fwd = forwardCurves.month(m);
+				auto* zr = zeroRates.month(m + 1);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					zr[s] = fwd[s] * mult;
+				}
+				SimpleImpliedRateBatch<IMPLIED_RATE_CALCULATOR>::logCompounding(impliedRateCalculator, zr, 1. / 12., zr, nScenarios);	// log compounding of the forward
+				for (size_t s = 0; s < nScenarios; ++s) {
+					logCompounding[s] += zr[s];
+					zr[s] = logCompounding[s] / (t_1 * freq);
+				}
+				SimpleMathKernels::expm1(zr, zr, nScenarios);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					zr[s] = zr[s] * freq / mult;
+				}
+			}
+			std::copy(zeroRates.month(1), zeroRates.month(1) + nScenarios, zeroRates.month(0));
+		}
+		// SimpleParShockTS::shock() on every scenario: the same par shock (in decimal) for every scenario
+		void parShock(
+			const SimpleScenarioMatrix& zeroRates,
+			const SimpleMonthlyShockProc& monthlyShocker,
+			SimpleScenarioMatrix& zeroRatesShocked
+		) {
+			auto& parYieldsShocked = rates_;
+			parYields(zeroRates, parYieldsShocked);
+			auto n = parYieldsShocked.months();
+			auto nScenarios = parYieldsShocked.scenarios();
+			auto mult = multiplier();
+			monthlyShocks(n, 1, monthlyShocker);
+			for (size_t m = 1; m < n; ++m) {
+				auto shock = shocks_[m] / mult;
+				auto* par = parYieldsShocked.month(m);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					par[s] += shock;
+				}
+			}
+			zeroRatesFromParYields(parYieldsShocked, zeroRatesShocked);
+		}
+		// SimpleMonthlyForwardShockTS::shock() on every scenario: the same monthly forward shock (in decimal) for every scenario
+		template <
+			typename IMPLIED_RATE_CALCULATOR = NominalSimpleImpliedRateCalculator
+		>
+		void forwardShock(
+			const SimpleScenarioMatrix& zeroRates,
+			const SimpleMonthlyShockProc& monthlyShocker,
+			SimpleScenarioMatrix& zeroRatesShocked
+		) {
+			SimpleScenarioMatrix& forwardCurvesShocked = annuities_;	// not used by the forward calculations
+			forwardCurves<IMPLIED_RATE_CALCULATOR>(zeroRates, forwardCurvesShocked, 1);
+			auto nForwards = forwardCurvesShocked.months();
+			auto nScenarios = forwardCurvesShocked.scenarios();
+			auto mult = multiplier();
+			monthlyShocks(nForwards, 0, monthlyShocker);
+			for (size_t f = 0; f < nForwards; ++f) {
+				auto shock = shocks_[f] / mult;
+				auto* fwd = forwardCurvesShocked.month(f);
+				for (size_t s = 0; s < nScenarios; ++s) {
+					fwd[s] += shock;
+				}
+			}
+			zeroRatesFromForwardCurves<IMPLIED_RATE_CALCULATOR>(forwardCurvesShocked, zeroRatesShocked);
+		}
+	};
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/utilities/thread-pool.hpp>
+#include <ql_utils/simple/span.hpp>
+#include <ql_utils/simple/ts-shock.hpp>
+#include <ql_utils/simple/ts-shocks/par-shock.hpp>
+#include <ql_utils/simple/ts-shocks/monthly-forward-shock.hpp>
+#include <ql_utils/simple/shock-pipeline.hpp>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+
+namespace QLUtils {
+	// shock of a scenario at a month, shock unit is QuantLib::Rate (decimal)
+	typedef std::function<QuantLib::Rate(size_t scenario, size_t month)> SimpleScenarioShockProc;
+
+	// shocked monthly zero rates of curves x scenarios, stored contiguously: data[(curve * scenarios + scenario) * months + month]
+	class SimpleScenarioCube {
+	private:
+		size_t curves_;
+		size_t scenarios_;
+		size_t months_;
+		std::vector<double> data_;
+	public:
+		SimpleScenarioCube(
+			size_t curves = 0,
+			size_t scenarios = 0,
+			size_t months = 0
+		) : curves_(curves), scenarios_(scenarios), months_(months), data_(curves * scenarios * months, 0.) {}
+		void resize(
+			size_t curves,
+			size_t scenarios,
+			size_t months
+		) {
+			curves_ = curves;
+			scenarios_ = scenarios;
+			months_ = months;
+			data_.resize(curves * scenarios * months);
+		}
+		size_t curves() const {
+			return curves_;
+		}
+		size_t scenarios() const {
+			return scenarios_;
+		}
+		size_t months() const {
+			return months_;
+		}
+		const std::vector<double>& data() const {
+			return data_;
+		}
+		// monthly zero rates of the curve under the scenario
+		SimpleRates curve(
+			size_t c,
+			size_t scenario
+		) {
+			return SimpleRates(data_.data() + (c * scenarios_ + scenario) * months_, months_);
+		}
+		SimpleConstRates curve(
+			size_t c,
+			size_t scenario
+		) const {
+			return SimpleConstRates(data_.data() + (c * scenarios_ + scenario) * months_, months_);
+		}
+		double& operator() (
+			size_t c,
+			size_t scenario,
+			size_t month
+		) {
+			return data_[(c * scenarios_ + scenario) * months_ + month];
+		}
+		double operator() (
+			size_t c,
+			size_t scenario,
+			size_t month
+		) const {
+			return data_[(c * scenarios_ + scenario) * months_ + month];
+		}
+	};
+
+	// multi-threaded driver of the shock classes (SimpleParShockTS, SimpleMonthlyForwardShockTS or a plain zero rate shock) over a set of
+	// base curves x a number of scenarios, gathering the shocked zero rates into a SimpleScenarioCube
+	// every (curve, scenario) pair is a task of the allocation free static shock() in the worker's own workspace, kept from one run() to the
+	// next. the tasks are split into one contiguous range per worker, each worker takes small chunks from the front of its own range and,
+	// when it runs dry, steals the back half of the largest remaining range, so uneven task costs do not leave workers idle
+	// the worker threads live as long as the driver. a driver runs one run() at a time
+	template <
+		typename IMPLIED_RATE_CALCULATOR = NominalSimpleImpliedRateCalculator,	// of the monthly forward rates
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	class SimpleScenarioDriver {
+	public:
+		typedef SimpleParShockTS<RATE_UNIT, COUPON_FREQ> ParShock;
+		typedef SimpleMonthlyForwardShockTS<IMPLIED_RATE_CALCULATOR, RATE_UNIT, COUPON_FREQ> ForwardShock;
+		// scratch space of a worker
+		struct Workspace {
+			typename ParShock::Workspace par;
+			typename ForwardShock::Workspace forward;
+		};
+	private:
+		// tasks [begin, end) left to a worker, the owner takes from the front and thieves from the back
+		struct TaskRange {
+			std::mutex mutex;
+			size_t begin = 0;
+			size_t end = 0;
+		};
+		SimpleShockSpace space_;
+		size_t chunkSize_;
+		std::vector<Workspace> workspaces_;
+		std::unique_ptr<TaskRange[]> ranges_;
+		std::unique_ptr<ThreadPool> pool_;
+		size_t steals_;
+	private:
+		static double multiplier() {
+			return SimpleShockTS<RATE_UNIT, COUPON_FREQ>::multiplier();
+		}
+		void shock(
+			SimpleConstRates monthlyZeroRates,
+			const SimpleMonthlyShockProc& monthlyShocker,
+			SimpleRates monthlyZeroRatesShocked,
+			Workspace& workspace
+		) const {
+			switch (space_) {
+			case ParRateSpace:
+				ParShock::shock(monthlyZeroRates, monthlyShocker, monthlyZeroRatesShocked, workspace.par);
+				break;
+			case MonthlyForwardSpace:
+				ForwardShock::shock(monthlyZeroRates, monthlyShocker, monthlyZeroRatesShocked, workspace.forward);
+				break;
+			default: {	// ZeroRateSpace
+				auto multiplier = this->multiplier();
+				auto n = monthlyZeroRates.size();
+				for (size_t month = 1; month < n; ++month) {
+					monthlyZeroRatesShocked[month] = monthlyZeroRates[month] + monthlyShocker(month) / multiplier;
+				}
+				monthlyZeroRatesShocked[0] = monthlyZeroRatesShocked[1];
+			}
+			}
+		}
+		// next chunk of tasks of the worker, from its own range or stolen. returns false when every range is empty
+		bool nextChunk(
+			size_t worker,
+			size_t& first,
+			size_t& last,
+			size_t& steals
+		) {
+			auto workers = workspaces_.size();
+			auto& own = ranges_[worker];
+			while (true) {
+				{
+					std::lock_guard<std::mutex> lock(own.mutex);
+					if (own.begin < own.end) {
+						first = own.begin;
+						last = std::min(own.end, own.begin + chunkSize_);
+						own.begin = last;
+						return true;
+					}
+				}
+				// steal the back half of the largest range
+				size_t victim = workers;
+				size_t largest = 0;
+				for (size_t w = 0; w < workers; ++w) {
+					if (w == worker) {
+						continue;
+					}
+					std::lock_guard<std::mutex> lock(ranges_[w].mutex);
+					auto remaining = ranges_[w].end - ranges_[w].begin;
+					if (remaining > largest) {
+						largest = remaining;
+						victim = w;
+					}
+				}
+				if (victim == workers) {	// nothing left anywhere
+					return false;
+				}
+				size_t stolenBegin = 0;
+				size_t stolenEnd = 0;
+				{
+					std::lock_guard<std::mutex> lock(ranges_[victim].mutex);
+					auto& range = ranges_[victim];
+					auto remaining = range.end - range.begin;
+					if (remaining == 0) {	// emptied in the meantime, look again
+						continue;
+					}
+					stolenEnd = range.end;
+					stolenBegin = range.end - (remaining + 1) / 2;
+					range.end = stolenBegin;
+				}
+				{
+					std::lock_guard<std::mutex> lock(own.mutex);
+					own.begin = stolenBegin;
+					own.end = stolenEnd;
+				}
+				++steals;
+			}
+		}
+	public:
+		SimpleScenarioDriver(
+			SimpleShockSpace space = ParRateSpace,
+			size_t numThreads = 0,	// 0 => one per hardware thread
+			size_t chunkSize = 8	// number of tasks a worker takes from its range at a time
+		) : space_(space), chunkSize_(std::max<size_t>(1, chunkSize)), steals_(0)
+		{
+			auto workers = (numThreads == 0 ? ThreadPool::defaultConcurrency() : numThreads);
+			workspaces_.resize(workers);
+			ranges_.reset(new TaskRange[workers]);
+			if (workers > 1) {
+				pool_.reset(new ThreadPool(workers));
+			}
+		}
+		SimpleShockSpace space() const {
+			return space_;
+		}
+		size_t numThreads() const {
+			return workspaces_.size();
+		}
+		// number of ranges stolen during the last run()
+		size_t steals() const {
+			return steals_;
+		}
+		// shock every base curve under every scenario into cube (curves x scenarios x months)
+		// all the base curves must have the same number of months
+		void run(
+			const std::vector<MonthlyZeroRates>& curves,	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
+			size_t scenarios,
+			const SimpleScenarioShockProc& scenarioShock,
+			SimpleScenarioCube& cube
+		) {
+			QL_REQUIRE(scenarioShock != nullptr, "scenario shock is not set");
+			auto nCurves = curves.size();
+			auto months = (nCurves > 0 ? curves[0].size() : 0);
+			for (const auto& curve : curves) {
+				QL_REQUIRE(curve.size() == months, "base curves must have the same number of months (" << curve.size() << " != " << months << ")");
+			}
+			QL_REQUIRE(nCurves == 0 || months >= 2, "too few zero rate nodes (" << months << "). The minimum is 2");
+			cube.resize(nCurves, scenarios, months);
+			steals_ = 0;
+			auto tasks = nCurves * scenarios;
+			if (tasks == 0) {
+				return;
+			}
+			auto workers = std::min(workspaces_.size(), tasks);
+			std::atomic<size_t> steals(0);
+			std::atomic<bool> failed(false);
+			auto work = [&](size_t worker) {
+				auto& workspace = workspaces_[worker];
+				size_t first = 0;
+				size_t last = 0;
+				size_t workerSteals = 0;
+				try {
+					while (!failed.load(std::memory_order_relaxed) && nextChunk(worker, first, last, workerSteals)) {
+						for (auto task = first; task < last; ++task) {
+							auto c = task / scenarios;
+							auto scenario = task % scenarios;
+							shock(curves[c], [&scenarioShock, scenario](size_t month) {
+								return scenarioShock(scenario, month);
+							}, cube.curve(c, scenario), workspace);
+						}
+					}
+				}
+				catch (...) {
+					failed = true;
+					steals += workerSteals;
+					throw;
+				}
+				steals += workerSteals;
+			};
+			for (size_t w = 0; w < workspaces_.size(); ++w) {	// contiguous ranges, workers beyond the number of tasks get nothing
+				ranges_[w].begin = std::min(tasks, tasks * w / workers);
+				ranges_[w].end = (w < workers ? tasks * (w + 1) / workers : tasks);
+			}
+			if (workers == 1 || pool_ == nullptr) {
+				work(0);
+			}
+			else {
+				for (size_t w = 0; w < workers; ++w) {
+					pool_->submit([&work, w]() {
+						work(w);
+					});
+				}
+				pool_->wait();
+			}
+			steals_ = steals;
+		}
+		// one scenario per shock
+		void run(
+			const std::vector<MonthlyZeroRates>& curves,
+			const std::vector<SimpleMonthlyShockProc>& shocks,
+			SimpleScenarioCube& cube
+		) {
+			for (const auto& shock : shocks) {
+				QL_REQUIRE(shock != nullptr, "shock is not set");
+			}
+			run(curves, shocks.size(), [&shocks](size_t scenario, size_t month) {
+				return shocks[scenario](month);
+			}, cube);
+		}
+		void run(
+			const std::vector<MonthlyZeroRates>& curves,
+			const std::vector<std::shared_ptr<ISimpleMonthlyShock>>& shocks,
+			SimpleScenarioCube& cube
+		) {
+			for (const auto& shock : shocks) {
+				QL_REQUIRE(shock != nullptr, "shock is not set");
+			}
+			run(curves, shocks.size(), [&shocks](size_t scenario, size_t month) {
+				return (*shocks[scenario])(month);
+			}, cube);
+		}
+	};
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace QLUtils {
+	// memory layout of a scenarios x months matrix exchanged with the caller
+	enum SimpleScenarioLayout {
+		ScenarioMajor = 0,	// data[scenario * months + month], ie: one monthly vector after the other
+		MonthMajor = 1	// data[month * scenarios + scenario]
+	};
+
+	// monthly rates (or discount factors) of a batch of scenarios, stored month-major (structure of arrays):
+	// the values of all the scenarios for a month are contiguous, so the batch calculations run their inner loops across the scenarios
+	class SimpleScenarioMatrix {
+	private:
+		size_t scenarios_;
+		size_t months_;
+		std::vector<double> data_;
+	public:
+		SimpleScenarioMatrix(
+			size_t scenarios = 0,
+			size_t months = 0
+		) : scenarios_(scenarios), months_(months), data_(scenarios * months, 0.) {}
+		void resize(
+			size_t scenarios,
+			size_t months
+		) {
+			scenarios_ = scenarios;
+			months_ = months;
+			data_.resize(scenarios * months);
+		}
+		size_t scenarios() const {
+			return scenarios_;
+		}
+		size_t months() const {
+			return months_;
+		}
+		// values of all the scenarios for the month
+		double* month(size_t m) {
+			return data_.data() + m * scenarios_;
+		}
+		const double* month(size_t m) const {
+			return data_.data() + m * scenarios_;
+		}
+		double& operator() (
+			size_t scenario,
+			size_t m
+		) {
+			return data_[m * scenarios_ + scenario];
+		}
+		double operator() (
+			size_t scenario,
+			size_t m
+		) const {
+			return data_[m * scenarios_ + scenario];
+		}
+		// copy in from the caller's scenarios x months data
+		void load(
+			const double* data,
+			size_t scenarios,
+			size_t months,
+			SimpleScenarioLayout layout = ScenarioMajor
+		) {
+			resize(scenarios, months);
+			if (layout == MonthMajor) {
+				std::copy(data, data + scenarios * months, data_.begin());
+			}
+			else {
+				for (size_t s = 0; s < scenarios; ++s) {
+					const auto* scenario = data + s * months;
+					for (size_t m = 0; m < months; ++m) {
+						data_[m * scenarios + s] = scenario[m];
+					}
+				}
+			}
+		}
+		// copy out to the caller's scenarios x months data
+		void store(
+			double* data,
+			SimpleScenarioLayout layout = ScenarioMajor
+		) const {
+			if (layout == MonthMajor) {
+				std::copy(data_.begin(), data_.end(), data);
+			}
+			else {
+				for (size_t s = 0; s < scenarios_; ++s) {
+					auto* scenario = data + s * months_;
+					for (size_t m = 0; m < months_; ++m) {
+						scenario[m] = data_[m * scenarios_ + s];
+					}
+				}
+			}
+		}
+		// monthly vector of one scenario
+		void scenario(
+			size_t s,
+			std::vector<double>& values
+		) const {
+			values.resize(months_);
+			for (size_t m = 0; m < months_; ++m) {
+				values[m] = data_[m * scenarios_ + s];
+			}
+		}
+	};
+}
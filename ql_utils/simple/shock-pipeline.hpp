@@ -0,0 +1,159 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/types.hpp>
+#include <ql_utils/simple/span.hpp>
+#include <ql_utils/simple/ts-shock.hpp>
+#include <ql_utils/simple/rate-calculators/fwd-rate-calculator.hpp>
+#include <ql_utils/simple/bootstraps/par-yield-ts-bootstrap.hpp>
+#include <ql_utils/simple/bootstraps/forward-to-zero-converter.hpp>
+#include <vector>
+#include <algorithm>
+
+namespace QLUtils {
+	// the space a shock is applied in
+	enum SimpleShockSpace {
+		ZeroRateSpace = 0,	// monthly zero rates, months 1..n-1 (month 0 follows month 1)
+		ParRateSpace = 1,	// spot par yields of every tenor month 1..n-1, as SimpleParShockTS
+		MonthlyForwardSpace = 2	// 1 month forward rates of forward months 0..n-2, as SimpleMonthlyForwardShockTS
+	};
+
+	// chain of shocks on a monthly zero curve, each in its own space, e.g. a par shock followed by a monthly forward shock
+	// run() applies the whole chain in one pass per curve on two ping-pong buffers of the workspace: the curve is converted between spaces
+	// only when the next stage is in another space (zero <=> par by the running annuity, zero <=> forward by compounding, par <=> forward
+	// through zero), consecutive stages in the same space shock the same buffer, and the result is converted back to zero rates once
+	// the stages are the same as the single shock classes: a chain of one par shock gives SimpleParShockTS's shocked zero rates
+	// once the workspace is warmed up no heap allocation is performed, the pipeline itself can be shared by threads with a workspace each
+	template <
+		typename IMPLIED_RATE_CALCULATOR = NominalSimpleImpliedRateCalculator,	// of the monthly forward rates
+		RateUnit RATE_UNIT = RateUnit::Percent,
+		QuantLib::Frequency COUPON_FREQ = QuantLib::Frequency::Semiannual
+	>
+	class SimpleShockPipeline {
+	private:
+		typedef SimpleParYieldTSBootstrapper<RATE_UNIT, COUPON_FREQ> Bootstrapper;
+		typedef SimpleForwardZeroConverter<IMPLIED_RATE_CALCULATOR, RATE_UNIT, COUPON_FREQ> Converter;
+	public:
+		struct Stage {
+			SimpleShockSpace space;
+			SimpleMonthlyShockProc shock;	// shock unit is QuantLib::Rate (decimal)
+		};
+		// work buffers of run(), reused from one call to the next
+		struct Workspace {
+			std::vector<double> buffers[2];	// ping-pong buffers
+			std::vector<double> annuities;
+			size_t conversions = 0;	// number of space conversions of the last run()
+		};
+	private:
+		std::vector<Stage> stages_;
+	private:
+		static double multiplier() {
+			return SimpleShockTS<RATE_UNIT, COUPON_FREQ>::multiplier();
+		}
+		// number of rates of the space for a zero curve of n months
+		static size_t size(
+			SimpleShockSpace space,
+			size_t n
+		) {
+			return (space == MonthlyForwardSpace ? n - 1 : n);
+		}
+		// converts the current buffer from its space to the target space into the other buffer, and makes it current
+		static void convert(
+			SimpleShockSpace from,
+			SimpleShockSpace to,
+			size_t n,
+			size_t& current,
+			Workspace& workspace
+		) {
+			if (from == to) {
+				return;
+			}
+			if (from != ZeroRateSpace && to != ZeroRateSpace) {	// par <=> forward through zero rates
+				convert(from, ZeroRateSpace, n, current, workspace);
+				convert(ZeroRateSpace, to, n, current, workspace);
+				return;
+			}
+			auto& src = workspace.buffers[current];
+			auto& dest = workspace.buffers[1 - current];
+			dest.resize(size(to, n));
+			if (from == ZeroRateSpace) {
+				if (to == ParRateSpace) {
+					Bootstrapper::monthlyParYields(src, dest, workspace.annuities);
+				}
+				else {	// MonthlyForwardSpace
+					Converter::forwardCurve(src, dest);
+				}
+			}
+			else if (from == ParRateSpace) {
+				Bootstrapper::stripParYields(src, dest, workspace.annuities);
+			}
+			else {	// MonthlyForwardSpace
+				Converter::bootstrap(src, dest);
+			}
+			current = 1 - current;
+			++workspace.conversions;
+		}
+	public:
+		SimpleShockPipeline() {}
+		const std::vector<Stage>& stages() const {
+			return stages_;
+		}
+		SimpleShockPipeline& add(
+			SimpleShockSpace space,
+			const SimpleMonthlyShockProc& shock
+		) {
+			QL_REQUIRE(shock != nullptr, "shock is not set");
+			stages_.push_back(Stage{space, shock});
+			return *this;
+		}
+		SimpleShockPipeline& zeroShock(const SimpleMonthlyShockProc& shock) {
+			return add(ZeroRateSpace, shock);
+		}
+		SimpleShockPipeline& parShock(const SimpleMonthlyShockProc& shock) {
+			return add(ParRateSpace, shock);
+		}
+		SimpleShockPipeline& forwardShock(const SimpleMonthlyShockProc& shock) {
+			return add(MonthlyForwardSpace, shock);
+		}
+		// applies the chain of shocks to the caller's zero rates into monthlyZeroRatesShocked (same size, may be the same memory)
+		void run(
+			SimpleConstRates monthlyZeroRates,	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
+			SimpleRates monthlyZeroRatesShocked,
+			Workspace& workspace
+		) const {
+			auto n = monthlyZeroRates.size();
+			QL_REQUIRE(n >= 2, "too few zero rate nodes (" << n << "). The minimum is 2");
+			QL_REQUIRE(monthlyZeroRatesShocked.size() == n, "shocked zero rates buffer size (" << monthlyZeroRatesShocked.size() << ") must be the zero rates' size (" << n << ")");
+			auto multiplier = this->multiplier();
+			workspace.conversions = 0;
+			size_t current = 0;
+			auto& input = workspace.buffers[current];
+			input.assign(monthlyZeroRates.begin(), monthlyZeroRates.end());
+			auto space = ZeroRateSpace;
+			for (const auto& stage : stages_) {
+				convert(space, stage.space, n, current, workspace);
+				space = stage.space;
+				auto& rates = workspace.buffers[current];
+				size_t first = (space == MonthlyForwardSpace ? 0 : 1);
+				for (size_t month = first; month < rates.size(); ++month) {
+					rates[month] += stage.shock(month) / multiplier;
+				}
+				if (space != MonthlyForwardSpace) {
+					rates[0] = rates[1];
+				}
+			}
+			convert(space, ZeroRateSpace, n, current, workspace);
+			const auto& result = workspace.buffers[current];
+			std::copy(result.begin(), result.end(), monthlyZeroRatesShocked.begin());
+		}
+		// convenience version allocating the result
+		MonthlyZeroRates run(
+			const MonthlyZeroRates& monthlyZeroRates
+		) const {
+			Workspace workspace;
+			MonthlyZeroRates ret(monthlyZeroRates.size());
+			run(monthlyZeroRates, ret, workspace);
+			return ret;
+		}
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <cstddef>
+
+namespace QLUtils {
+	// non-owning view of a contiguous sequence (a std::vector, a row of a SimpleScenarioMatrix, a caller's buffer...)
+	// used by the allocation free interfaces of the simple curve classes. the viewed memory must outlive the span
+	template <
+		typename T
+	>
+	class SimpleSpan {
+	private:
+		T* data_;
+		size_t size_;
+	public:
+		SimpleSpan() : data_(nullptr), size_(0) {}
+		SimpleSpan(
+			T* data,
+			size_t size
+		) : data_(data), size_(size) {}
+		template <
+			typename Container	// std::vector or any contiguous container with data() and size()
+		>
+		SimpleSpan(
+			Container& container
+		) : data_(container.data()), size_(container.size()) {}
+		T* data() const {
+			return data_;
+		}
+		size_t size() const {
+			return size_;
+		}
+		bool empty() const {
+			return size_ == 0;
+		}
+		T* begin() const {
+			return data_;
+		}
+		T* end() const {
+			return data_ + size_;
+		}
+		T& operator[] (
+			size_t i
+		) const {
+			return data_[i];
+		}
+		T& back() const {
+			return data_[size_ - 1];
+		}
+		SimpleSpan subspan(
+			size_t offset,
+			size_t count
+		) const {
+			QL_REQUIRE(offset + count <= size_, "sub span [" << offset << ", " << (offset + count) << ") is out of the span's range (" << size_ << ")");
+			return SimpleSpan(data_ + offset, count);
+		}
+	};
+
+	typedef SimpleSpan<const double> SimpleConstRates;
+	typedef SimpleSpan<double> SimpleRates;
+}
@@ -32,6 +32,40 @@ namespace QLUtils {
 		) {
 			return Converter::forwardCurve(monthlyZeroRates, 1);	// monthly forward curve means tenor is 1 month
 		}
+		// work buffers of the allocation free shock(), reused from one call to the next
+		struct Workspace {
+			MonthlyForwardCurve forwardCurve;	// after shock()
+			std::vector<QuantLib::Rate> monthlyShocks;	// after shock()
+			MonthlyForwardCurve forwardCurveShocked;	// after shock()
+		};
+		// allocation free shock() for scenario loops: the monthly forward curve of the caller's zero rates is shocked and bootstrapped back
+		// into the caller's monthlyZeroRatesShocked (same size as monthlyZeroRates, may be the same memory)
+		// once the workspace is warmed up no heap allocation is performed
+		static void shock(
+			SimpleConstRates monthlyZeroRates,
+			const SimpleMonthlyShockProc& monthlyShocker,	// shock unit is QuantLib::Rate (decimal)
+			SimpleRates monthlyZeroRatesShocked,
+			Workspace& workspace
+		) {
+			auto n_zeros = monthlyZeroRates.size();
+			QL_REQUIRE(n_zeros >= 2, "too few zero rate nodes (" << n_zeros << "). The minimum is 2");
+			QL_REQUIRE(monthlyZeroRatesShocked.size() == n_zeros, "shocked zero rates buffer size (" << monthlyZeroRatesShocked.size() << ") must be the zero rates' size (" << n_zeros << ")");
+			auto multiplier = SimpleShockTS<RATE_UNIT, COUPON_FREQ>::multiplier();
+			auto n = n_zeros - 1;
+			auto& forwardCurve = workspace.forwardCurve;
+			auto& monthlyShocks = workspace.monthlyShocks;
+			auto& forwardCurveShocked = workspace.forwardCurveShocked;
+			forwardCurve.resize(n);
+			monthlyShocks.resize(n);
+			forwardCurveShocked.resize(n);
+			Converter::forwardCurve(monthlyZeroRates, forwardCurve);
+			for (decltype(n) fwdMonth = 0; fwdMonth < n; ++fwdMonth) {
+				auto shock = monthlyShocker(fwdMonth);	// in the unit of QuantLib::Rate
+				monthlyShocks[fwdMonth] = shock;
+				forwardCurveShocked[fwdMonth] = (forwardCurve[fwdMonth] * multiplier + shock) / multiplier;
+			}
+			Converter::bootstrap(forwardCurveShocked, monthlyZeroRatesShocked);
+		}
 		SimpleMonthlyForwardShockTS(
 			const MonthlyZeroRates& monthlyZeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
 		) : SimpleShockTS<RATE_UNIT, COUPON_FREQ>(monthlyZeroRates)
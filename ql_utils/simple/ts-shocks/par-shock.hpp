@@ -29,6 +29,44 @@ namespace QLUtils {
 		std::shared_ptr<std::vector<QuantLib::Rate>> pParShocks;
 		std::shared_ptr<std::vector<double>> pParYieldsShocked;
 	public:
+		// work buffers of the allocation free shock(), reused from one call to the next
+		struct Workspace {
+			std::vector<double> annuities;
+			std::vector<double> parYields;	// par yield of every tenor month (month 0 = month 1) after shock()
+			std::vector<QuantLib::Rate> parShocks;	// par shock of every tenor month after shock()
+			std::vector<double> parYieldsShocked;	// shocked par yield of every tenor month (month 0 = month 1) after shock()
+		};
+		// allocation free shock() for scenario loops: the par yields of every tenor month of the caller's zero rates are shocked and
+		// stripped back with the running annuity into the caller's monthlyZeroRatesShocked (same size as monthlyZeroRates, may be the same memory)
+		// the par yield of every month being given, the bootstrapper's spline is not needed
+		// once the workspace is warmed up no heap allocation is performed
+		static void shock(
+			SimpleConstRates monthlyZeroRates,
+			const SimpleMonthlyShockProc& monthlyShocker,	// shock unit is QuantLib::Rate (decimal)
+			SimpleRates monthlyZeroRatesShocked,
+			Workspace& workspace
+		) {
+			auto n = monthlyZeroRates.size();
+			QL_REQUIRE(n >= 2, "too few zero rate nodes (" << n << "). The minimum is 2");
+			QL_REQUIRE(monthlyZeroRatesShocked.size() == n, "shocked zero rates buffer size (" << monthlyZeroRatesShocked.size() << ") must be the zero rates' size (" << n << ")");
+			auto multiplier = ParRateCalculator::multiplier();
+			auto& annuities = workspace.annuities;
+			auto& parYields = workspace.parYields;
+			auto& parShocks = workspace.parShocks;
+			auto& parYieldsShocked = workspace.parYieldsShocked;
+			parYields.resize(n);
+			parShocks.resize(n);
+			parYieldsShocked.resize(n);
+			Bootstrapper::monthlyParYields(monthlyZeroRates, parYields, annuities);
+			for (decltype(n) tenorMonth = 1; tenorMonth < n; ++tenorMonth) {	// for each month
+				auto parShock = monthlyShocker(tenorMonth);
+				parShocks[tenorMonth] = parShock;
+				parYieldsShocked[tenorMonth] = (parYields[tenorMonth] * multiplier + parShock) / multiplier;
+			}
+			parShocks[0] = parShocks[1];
+			parYieldsShocked[0] = parYieldsShocked[1];
+			Bootstrapper::stripParYields(parYieldsShocked, monthlyZeroRatesShocked, annuities);
+		}
 		SimpleParShockTS(
 			const MonthlyZeroRates& monthlyZeroRates	// zero rate vectors, compounded in COUPON_FREQ, first element must be the spot zero rate (ie: month=0)
 		) : SimpleShockTS<RATE_UNIT, COUPON_FREQ>(monthlyZeroRates)
@@ -4,6 +4,7 @@
 #include <memory>
 #include <ql_utils/indexes/ois-swap-index.hpp>
 #include <ql_utils/fixing-date-adjustment.hpp>
+#include <ql_utils/valuation-context.hpp>
 #include <ql_utils/utilities/time.hpp>
 #include <ql_utils/ratehelpers/swap-rate-helper-ex.hpp>
 
@@ -81,15 +82,15 @@ namespace QLUtils {
         virtual pRateHelper makeRateHelper(
             QuantLib::Rate quotedFixedRate,
             const QuantLib::Date& startDate,
-            const YieldTermStructureHandle& discountingTermStructure = {}   // exogenous discounting curve
+            const YieldTermStructureHandle& discountingTermStructure = {},   // exogenous discounting curve
+            const ValuationContext& valuationContext = {}   // provides today
         ) const = 0;
         // calculate the fixing date and effective date for a given reference date (default to evaluation date if not provided)
         FixingResult calculateFixing(
-            QuantLib::Date refDate = QuantLib::Date()
+            QuantLib::Date refDate = QuantLib::Date(),
+            const ValuationContext& valuationContext = {}   // provides the evaluation date
         ) const {
-            if (refDate == QuantLib::Date()) {
-                refDate = QuantLib::Settings::instance().evaluationDate();
-            }
+            refDate = valuationContext.today(refDate);
             auto fixingCalendar = this->fixingCalendar();
             auto settlementDays = this->settlementDays();
             QuantLib::Utils::FixingDateAdjustment fixingAdj(settlementDays, fixingCalendar);
@@ -102,14 +103,15 @@ namespace QLUtils {
                 startDate
             };
         }
-        // from the valuation/reference date set by QuantLib::Settings::instance().evaluationDate(),
+        // from the valuation/reference date of the valuation context (QuantLib::Settings::instance().evaluationDate() by default),
         // find the number of settlement days that would yield the expected swap start/effective date
         QuantLib::Natural getMatchingSettlementDays(
-            const QuantLib::Date& startDate // target start/effective date for the swap
+            const QuantLib::Date& startDate, // target start/effective date for the swap
+            const ValuationContext& valuationContext = {}   // provides the valuation/reference date
         ) const {
             auto fixingCalendar = this->fixingCalendar();
             QL_REQUIRE(fixingCalendar.isBusinessDay(startDate), "swap start/effective date (" << startDate << ") is not a business day of the swap fixing calendar");
-            auto refDate = QuantLib::Settings::instance().evaluationDate();
+            auto refDate = valuationContext.evaluationDate();
             QL_REQUIRE(refDate != QuantLib::Date(), "evaluation/reference date is not set");
             refDate = fixingCalendar.adjust(refDate);   // refDate is now a business day on the fixing calendar
             QL_REQUIRE(refDate <= startDate, "evaluation/reference date (" << refDate << ") is after the target swap start/effective date (" << startDate << ")");
@@ -277,9 +279,10 @@ namespace QLUtils {
         virtual pRateHelper makeRateHelper(
             QuantLib::Rate quotedFixedRate,
             const QuantLib::Date& startDate,
-            const YieldTermStructureHandle& discountingTermStructure = {}   // exogenous discounting curve
+            const YieldTermStructureHandle& discountingTermStructure = {},   // exogenous discounting curve
+            const ValuationContext& valuationContext = {}   // provides today
         ) const override {
-            auto settlementDays = getMatchingSettlementDays(startDate);
+            auto settlementDays = getMatchingSettlementDays(startDate, valuationContext);
             auto overnightIndex = makeOvernightIndex();
             QuantLib::ext::shared_ptr<QuantLib::OISRateHelper> helper(
                 new QuantLib::OISRateHelper(
@@ -473,9 +476,10 @@ namespace QLUtils {
         virtual pRateHelper makeRateHelper(
             QuantLib::Rate quotedFixedRate,
             const QuantLib::Date& startDate,
-            const YieldTermStructureHandle& discountingTermStructure = {}   // exogenous discounting curve
+            const YieldTermStructureHandle& discountingTermStructure = {},   // exogenous discounting curve
+            const ValuationContext& valuationContext = {}   // provides today
         ) const override {
-            auto settlementDays = getMatchingSettlementDays(startDate);
+            auto settlementDays = getMatchingSettlementDays(startDate, valuationContext);
             auto iborIndex = makeIborIndex();
             QuantLib::ext::shared_ptr<QuantLib::SwapRateHelperEx> helper(
                 new QuantLib::SwapRateHelperEx(
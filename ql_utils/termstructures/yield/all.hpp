@@ -2,3 +2,4 @@
 
 #include <ql_utils/termstructures/yield/interpolatedsimplezerocurve.hpp>
 #include <ql_utils/termstructures/yield/bootstraptraits.hpp>
+#include <ql_utils/termstructures/yield/suffixiterativebootstrap.hpp>
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace QuantLib {
+    namespace Utils {
+        //! Iterative bootstrap that only re-solves the pillars after the first changed quote
+        /*! Drop-in replacement for QuantLib::IterativeBootstrap, to be used as the
+            bootstrap template argument of PiecewiseYieldCurve.
+
+            The first calculation, and any calculation with a global interpolator,
+            a moving curve or a failed previous solve, is the regular sequential
+            bootstrap (warm-started from the previous solution when available).
+
+            Otherwise, since a sequential bootstrap of a local interpolator solves
+            pillar i from the pillars before it only, a recalculation triggered by
+            quote changes keeps the solved pillars 1..k-1 and re-solves k..n, where
+            k is the pillar of the first helper whose quote changed. The prefix is
+            kept only if its helpers still reprice as they did at the end of the
+            last solve, so that a change of anything else the helpers depend on
+            (e.g. an exogenous discount curve) still triggers a full re-solve.
+        */
+        template <class Curve>
+        class SuffixIterativeBootstrap {
+            typedef typename Curve::traits_type Traits;
+            typedef typename Curve::interpolator_type Interpolator;
+          public:
+            explicit SuffixIterativeBootstrap(Real accuracy = 1.0e-12)
+            : ts_(nullptr), n_(0), accuracy_(accuracy), initialized_(false), validCurve_(false),
+              firstAliveHelper_(0), alive_(0) {}
+            void setup(Curve* ts);
+            void calculate() const;
+          private:
+            void initialize() const;
+            // first pillar that has to be re-solved (1 => all of them)
+            Size firstPillarToSolve() const;
+            void solve(Size firstPillar, bool validData) const;
+            void recordSolution(Size firstPillar) const;
+            Curve* ts_;
+            Size n_;
+            Real accuracy_;
+            Brent firstSolver_;
+            FiniteDifferenceNewtonSafe solver_;
+            mutable bool initialized_, validCurve_;
+            mutable Size firstAliveHelper_, alive_;
+            mutable std::vector<Real> previousData_;
+            mutable std::vector<ext::shared_ptr<BootstrapError<Curve> > > errors_;
+            // helper quotes and quote errors at the end of the last solve, indexed by pillar
+            mutable std::vector<Real> solvedQuotes_, solvedQuoteErrors_;
+        };
+
+
+        // template definitions
+
+        template <class Curve>
+        void SuffixIterativeBootstrap<Curve>::setup(Curve* ts) {
+            ts_ = ts;
+            n_ = ts_->instruments_.size();
+            QL_REQUIRE(n_ > 0, "no bootstrap helpers given");
+            for (Size j = 0; j < n_; ++j)
+                ts_->registerWith(ts_->instruments_[j]);
+            // do not initialize yet: instruments could be invalid here
+            // but fixed later on
+        }
+
+        template <class Curve>
+        void SuffixIterativeBootstrap<Curve>::initialize() const {
+            // ensure helpers are sorted
+            std::sort(ts_->instruments_.begin(), ts_->instruments_.end(),
+                      detail::BootstrapHelperSorter());
+
+            // skip expired helpers
+            Date firstDate = Traits::initialDate(ts_);
+            QL_REQUIRE(ts_->instruments_[n_ - 1]->pillarDate() > firstDate,
+                       "all instruments expired");
+            firstAliveHelper_ = 0;
+            while (ts_->instruments_[firstAliveHelper_]->pillarDate() <= firstDate)
+                ++firstAliveHelper_;
+            alive_ = n_ - firstAliveHelper_;
+            QL_REQUIRE(alive_ + 1 >= Interpolator::requiredPoints,
+                       "not enough alive instruments: " << alive_ << " provided, "
+                       << Interpolator::requiredPoints - 1 << " required");
+
+            std::vector<Date>& dates = ts_->dates_;
+            std::vector<Time>& times = ts_->times_;
+            dates.resize(alive_ + 1);
+            times.resize(alive_ + 1);
+            errors_.resize(alive_ + 1);
+            dates[0] = firstDate;
+            times[0] = ts_->timeFromReference(dates[0]);
+
+            Date maxDate = firstDate;
+            for (Size i = 1, j = firstAliveHelper_; j < n_; ++i, ++j) {
+                const auto& helper = ts_->instruments_[j];
+                dates[i] = helper->pillarDate();
+                times[i] = ts_->timeFromReference(dates[i]);
+                QL_REQUIRE(dates[i - 1] != dates[i],
+                           "more than one instrument with pillar " << dates[i]);
+                Date latestRelevantDate = helper->latestRelevantDate();
+                QL_REQUIRE(latestRelevantDate > maxDate,
+                           io::ordinal(j + 1) << " instrument (pillar: " << dates[i]
+                           << ") has latestRelevantDate (" << latestRelevantDate
+                           << ") before or equal to previous instrument's latestRelevantDate ("
+                           << maxDate << ")");
+                maxDate = latestRelevantDate;
+                errors_[i] = ext::make_shared<BootstrapError<Curve> >(ts_, helper, i);
+            }
+            ts_->maxDate_ = maxDate;
+
+            // set initial guess only if the current curve cannot be used as guess
+            if (!validCurve_ || ts_->data_.size() != alive_ + 1) {
+                // ts_->data_[0] is the only relevant item,
+                // but reasonable numbers might be needed for the whole data vector
+                // because, e.g., of interpolation's early checks
+                ts_->data_ = std::vector<Real>(alive_ + 1, Traits::initialValue(ts_));
+                previousData_.resize(alive_ + 1);
+                validCurve_ = false;
+            }
+            solvedQuotes_.assign(alive_ + 1, Null<Real>());
+            solvedQuoteErrors_.assign(alive_ + 1, Null<Real>());
+            initialized_ = true;
+        }
+
+        template <class Curve>
+        Size SuffixIterativeBootstrap<Curve>::firstPillarToSolve() const {
+            if (Interpolator::global || !validCurve_)
+                return 1;
+            Size k = 1;
+            while (k <= alive_ &&
+                   ts_->instruments_[firstAliveHelper_ + k - 1]->quote()->value() == solvedQuotes_[k])
+                ++k;
+            if (k > alive_)  // no quote changed, something else triggered the recalculation
+                return 1;
+            for (Size i = 1; i < k; ++i) {
+                if (solvedQuoteErrors_[i] == Null<Real>())
+                    return 1;
+                Real error = ts_->instruments_[firstAliveHelper_ + i - 1]->quoteError();
+                if (std::fabs(error - solvedQuoteErrors_[i]) > accuracy_)
+                    return 1;
+            }
+            return k;
+        }
+
+        template <class Curve>
+        void SuffixIterativeBootstrap<Curve>::solve(Size firstPillar, bool validData) const {
+            const std::vector<Time>& times = ts_->times_;
+            const std::vector<Real>& data = ts_->data_;
+            Size maxIterations = Traits::maxIterations() - 1;
+            for (Size iteration = 0;; ++iteration) {
+                previousData_ = ts_->data_;
+                for (Size i = firstPillar; i <= alive_; ++i) {
+                    Real min = Traits::minValueAfter(i, ts_, validData, firstAliveHelper_);
+                    Real max = Traits::maxValueAfter(i, ts_, validData, firstAliveHelper_);
+                    Real guess = Traits::guess(i, ts_, validData, firstAliveHelper_);
+                    // adjust guess if needed
+                    if (guess >= max)
+                        guess = max - (max - min) / 5.0;
+                    else if (guess <= min)
+                        guess = min + (max - min) / 5.0;
+
+                    // extend interpolation if needed
+                    if (!validData) {
+                        try { // extend interpolation a point at a time
+                              // including the pillar to be bootstrapped
+                            ts_->interpolation_ = ts_->interpolator_.interpolate(
+                                times.begin(), times.begin() + i + 1, data.begin());
+                        } catch (...) {
+                            if (!Interpolator::global)
+                                throw; // no chance to fix it in a later iteration
+
+                            // otherwise use Linear while the target
+                            // interpolation is not usable yet
+                            ts_->interpolation_ = Linear().interpolate(
+                                times.begin(), times.begin() + i + 1, data.begin());
+                        }
+                        ts_->interpolation_.update();
+                    }
+
+                    try {
+                        if (validData)
+                            solver_.solve(*errors_[i], accuracy_, guess, min, max);
+                        else
+                            firstSolver_.solve(*errors_[i], accuracy_, guess, min, max);
+                    } catch (std::exception& e) {
+                        QL_FAIL(io::ordinal(iteration + 1) << " iteration: failed "
+                                "at " << io::ordinal(i) << " alive instrument, "
+                                "pillar " << errors_[i]->helper()->pillarDate() <<
+                                ", maturity " << errors_[i]->helper()->maturityDate() <<
+                                ", reference date " << ts_->dates_[0] <<
+                                ": " << e.what());
+                    }
+                }
+
+                if (!Interpolator::global)
+                    break; // no need for convergence loop
+
+                // exit condition
+                Real change = std::fabs(data[1] - previousData_[1]);
+                for (Size i = 2; i <= alive_; ++i)
+                    change = std::max(change, std::fabs(data[i] - previousData_[i]));
+                if (change <= accuracy_) // convergence reached
+                    break;
+
+                QL_REQUIRE(iteration < maxIterations,
+                           "convergence not reached after " << iteration + 1 <<
+                           " iterations; last improvement " << change <<
+                           ", required accuracy " << accuracy_);
+                validData = true;
+            }
+        }
+
+        template <class Curve>
+        void SuffixIterativeBootstrap<Curve>::recordSolution(Size firstPillar) const {
+            // a helper only depends on the curve up to its latest relevant date; helpers
+            // ending before the first re-solved segment still have their recorded errors
+            Date unchangedUntil = (firstPillar > 1 ? ts_->dates_[firstPillar - 1] : Date());
+            for (Size i = 1; i <= alive_; ++i) {
+                const auto& helper = ts_->instruments_[firstAliveHelper_ + i - 1];
+                solvedQuotes_[i] = helper->quote()->value();
+                if (firstPillar == 1 || helper->latestRelevantDate() > unchangedUntil ||
+                    solvedQuoteErrors_[i] == Null<Real>())
+                    solvedQuoteErrors_[i] = helper->quoteError();
+            }
+        }
+
+        template <class Curve>
+        void SuffixIterativeBootstrap<Curve>::calculate() const {
+            // we might have to call initialize even if the curve is initialized
+            // and not moving, just because helpers might be date relative and change
+            // with evaluation date change.
+            // anyway it makes little sense to use date relative helpers with a
+            // non-moving curve if the evaluation date changes
+            if (!initialized_ || ts_->moving_)
+                initialize();
+
+            // setup helpers
+            for (Size j = firstAliveHelper_; j < n_; ++j) {
+                const auto& helper = ts_->instruments_[j];
+                // check for valid quote
+                QL_REQUIRE(helper->quote()->isValid(),
+                           io::ordinal(j + 1) << " instrument (maturity: " <<
+                           helper->maturityDate() << ", pillar: " <<
+                           helper->pillarDate() << ") has an invalid quote");
+                // don't try this at home!
+                // This call creates helpers, and removes "const".
+                // There is a significant interaction with observability.
+                helper->setTermStructure(const_cast<Curve*>(ts_));
+            }
+
+            Size firstPillar = firstPillarToSolve();
+            try {
+                solve(firstPillar, validCurve_);
+            } catch (...) {
+                if (!validCurve_)
+                    throw;
+                // the previous curve state might have been a bad guess,
+                // so we retry from scratch without using it
+                validCurve_ = initialized_ = false;
+                calculate();
+                return;
+            }
+            validCurve_ = true;
+            if (!Interpolator::global)
+                recordSolution(firstPillar);
+        }
+    }
+}
@@ -251,6 +251,7 @@ namespace QLUtils {
     typedef std::vector<QuantLib::Real> MonthlyForwardCurve;
     typedef std::vector<QuantLib::Real> MonthlyRates;
     typedef MonthlyRates HistoricalMonthlyRates;
+    typedef std::vector<QuantLib::Real> GridZeroRates;    // zero rates of a day/week/month grid, element i being i grid periods from the reference date
 
     struct IParYieldSplineNode {
         virtual QuantLib::Time parTerm() const = 0;
@@ -9,3 +9,5 @@
 #include <ql_utils/utilities/time.hpp>
 #include <ql_utils/utilities/iso-date-conv.hpp>
 #include <ql_utils/utilities/ramp.hpp>
+#include <ql_utils/utilities/thread-pool.hpp>
+#include <ql_utils/utilities/monthly-date-grid.hpp>
\ No newline at end of file
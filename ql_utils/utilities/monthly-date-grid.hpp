@@ -0,0 +1,143 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <map>
+#include <tuple>
+#include <string>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+namespace QLUtils {
+	// monthly grid of a reference date: period[month] = month * Months, date[month] = referenceDate + period[month], and
+	// time[month] = the day counter's year fraction from the reference date to date[month], for months 0..maxMonth
+	class MonthlyDateGrid {
+	private:
+		QuantLib::Date referenceDate_;
+		QuantLib::DayCounter dayCounter_;
+		std::vector<QuantLib::Period> periods_;
+		std::vector<QuantLib::Date> dates_;
+		std::vector<QuantLib::Time> times_;
+	public:
+		MonthlyDateGrid(
+			const QuantLib::Date& referenceDate,
+			size_t maxMonth,
+			const QuantLib::DayCounter& dayCounter = QuantLib::Actual365Fixed()
+		) : referenceDate_(referenceDate), dayCounter_(dayCounter), periods_(maxMonth + 1), dates_(maxMonth + 1), times_(maxMonth + 1)
+		{
+			QL_REQUIRE(referenceDate != QuantLib::Date(), "reference date is not set");
+			QL_REQUIRE(!dayCounter.empty(), "day counter is not set");
+			for (size_t month = 0; month <= maxMonth; ++month) {
+				periods_[month] = QuantLib::Period((QuantLib::Integer)month, QuantLib::Months);
+				dates_[month] = referenceDate + periods_[month];
+				times_[month] = dayCounter.yearFraction(referenceDate, dates_[month]);
+			}
+		}
+		const QuantLib::Date& referenceDate() const {
+			return referenceDate_;
+		}
+		const QuantLib::DayCounter& dayCounter() const {
+			return dayCounter_;
+		}
+		// number of months in the grid, ie: maxMonth + 1
+		size_t size() const {
+			return dates_.size();
+		}
+		size_t maxMonth() const {
+			return dates_.size() - 1;
+		}
+		const std::vector<QuantLib::Period>& periods() const {
+			return periods_;
+		}
+		const std::vector<QuantLib::Date>& dates() const {
+			return dates_;
+		}
+		const std::vector<QuantLib::Time>& times() const {
+			return times_;
+		}
+		const QuantLib::Period& period(size_t month) const {
+			return periods_[month];
+		}
+		const QuantLib::Date& date(size_t month) const {
+			return dates_[month];
+		}
+		QuantLib::Time time(size_t month) const {
+			return times_[month];
+		}
+	};
+
+	typedef std::shared_ptr<const MonthlyDateGrid> pMonthlyDateGrid;
+
+	// cache of the monthly date grids by (reference date, day counter, max month), so the curves of a scenario batch over one as-of date
+	// share one grid and the calendar arithmetic is done once. the grids are immutable and can be shared by any number of threads
+	// above the capacity the grids of the earliest reference date are evicted first (the batches move forward in time)
+	class MonthlyDateGridCache {
+	private:
+		typedef std::tuple<QuantLib::Date::serial_type, std::string, size_t> Key;
+		size_t capacity_;
+		std::map<Key, pMonthlyDateGrid> grids_;
+		mutable std::mutex mutex_;
+	public:
+		MonthlyDateGridCache(
+			size_t capacity = 256	// max number of cached grids
+		) : capacity_(capacity) {
+			QL_REQUIRE(capacity > 0, "date grid cache capacity must be positive");
+		}
+		MonthlyDateGridCache(const MonthlyDateGridCache&) = delete;
+		MonthlyDateGridCache& operator = (const MonthlyDateGridCache&) = delete;
+		// process wide cache shared by the simple bootstrapper and the monthly shockers
+		static MonthlyDateGridCache& instance() {
+			static MonthlyDateGridCache cache;
+			return cache;
+		}
+		// the grid of months 0..maxMonth of the reference date
+		pMonthlyDateGrid grid(
+			const QuantLib::Date& referenceDate,
+			size_t maxMonth,
+			const QuantLib::DayCounter& dayCounter = QuantLib::Actual365Fixed()
+		) {
+			QL_REQUIRE(!dayCounter.empty(), "day counter is not set");
+			Key key(referenceDate.serialNumber(), dayCounter.name(), maxMonth);
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				auto p = grids_.find(key);
+				if (p != grids_.end()) {
+					return p->second;
+				}
+			}
+			pMonthlyDateGrid grid(new MonthlyDateGrid(referenceDate, maxMonth, dayCounter));	// outside of the lock
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto inserted = grids_.insert(std::make_pair(key, grid));
+			if (!inserted.second) {	// built by another thread in the meantime
+				grid = inserted.first->second;
+			}
+			while (grids_.size() > capacity_) {
+				grids_.erase(grids_.begin());
+			}
+			return grid;
+		}
+		// the grid of the reference date long enough to reach maxDate, ie: its last date is the first monthly date on or after maxDate
+		pMonthlyDateGrid grid(
+			const QuantLib::Date& referenceDate,
+			const QuantLib::Date& maxDate,
+			const QuantLib::DayCounter& dayCounter = QuantLib::Actual365Fixed()
+		) {
+			QL_REQUIRE(maxDate >= referenceDate, "max date (" << maxDate << ") is before the reference date (" << referenceDate << ")");
+			auto months = (QuantLib::Integer)(maxDate.year() - referenceDate.year()) * 12 + ((QuantLib::Integer)maxDate.month() - (QuantLib::Integer)referenceDate.month());
+			months = std::max<QuantLib::Integer>(months - 1, 0);
+			while (referenceDate + QuantLib::Period(months, QuantLib::Months) < maxDate) {	// at most a couple of iterations
+				++months;
+			}
+			return grid(referenceDate, (size_t)months, dayCounter);
+		}
+		size_t size() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return grids_.size();
+		}
+		void clear() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			grids_.clear();
+		}
+	};
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+namespace QLUtils {
+    // fixed size pool of worker threads consuming a shared FIFO task queue
+    // the first exception escaping a task is captured and re-thrown by wait()
+    class ThreadPool {
+    public:
+        typedef std::function<void()> Task;
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<Task> tasks_;
+        std::mutex mutex_;
+        std::condition_variable taskAvailable_;
+        std::condition_variable idle_;
+        std::size_t pending_;  // number of tasks queued or running
+        bool stopping_;
+        std::exception_ptr error_;
+        void workerLoop() {
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    taskAvailable_.wait(lock, [this]() {return stopping_ || !tasks_.empty();});
+                    if (tasks_.empty()) {   // stopping_ and nothing left to do
+                        return;
+                    }
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                try {
+                    task();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (error_ == nullptr) {
+                        error_ = std::current_exception();
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (--pending_ == 0) {
+                        idle_.notify_all();
+                    }
+                }
+            }
+        }
+    public:
+        // numThreads = 0 => one worker per hardware thread
+        explicit ThreadPool(
+            std::size_t numThreads = 0
+        ) : pending_(0), stopping_(false) {
+            if (numThreads == 0) {
+                numThreads = defaultConcurrency();
+            }
+            workers_.reserve(numThreads);
+            for (std::size_t i = 0; i < numThreads; ++i) {
+                workers_.emplace_back([this]() {workerLoop();});
+            }
+        }
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            taskAvailable_.notify_all();
+            for (auto& worker : workers_) {
+                worker.join();
+            }
+        }
+        static std::size_t defaultConcurrency() {
+            return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        }
+        std::size_t size() const {
+            return workers_.size();
+        }
+        // queue a task for execution on one of the workers
+        void submit(Task task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+                ++pending_;
+            }
+            taskAvailable_.notify_one();
+        }
+        // block until every submitted task has finished, re-throw the first task exception (if any)
+        void wait() {
+            std::exception_ptr error;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                idle_.wait(lock, [this]() {return pending_ == 0;});
+                std::swap(error, error_);
+            }
+            if (error != nullptr) {
+                std::rethrow_exception(error);
+            }
+        }
+        // run f(i) for i in [begin, end) across the workers and block until all of them are done
+        // the range is split into contiguous chunks, roughly 4 per worker, to keep the queue overhead low
+        // must not be called from a task running on this same pool (the calling worker would block on itself)
+        template <
+            typename F
+        >
+        void parallelFor(
+            std::size_t begin,
+            std::size_t end,
+            const F& f
+        ) {
+            if (end <= begin) {
+                return;
+            }
+            auto n = end - begin;
+            auto numChunks = std::min(n, size() * 4);
+            auto chunkSize = (n + numChunks - 1) / numChunks;
+            std::mutex doneMutex;
+            std::condition_variable doneCondition;
+            std::size_t remaining = 0;
+            std::exception_ptr error;
+            for (auto first = begin; first < end; first += chunkSize) {
+                ++remaining;
+            }
+            for (auto first = begin; first < end; first += chunkSize) {
+                auto last = std::min(end, first + chunkSize);
+                submit([&, first, last]() {
+                    std::exception_ptr chunkError;
+                    try {
+                        for (auto i = first; i < last; ++i) {
+                            f(i);
+                        }
+                    }
+                    catch (...) {
+                        chunkError = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    if (chunkError != nullptr && error == nullptr) {
+                        error = chunkError;
+                    }
+                    if (--remaining == 0) {
+                        doneCondition.notify_all();
+                    }
+                });
+            }
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCondition.wait(lock, [&remaining]() {return remaining == 0;});
+            if (error != nullptr) {
+                std::rethrow_exception(error);
+            }
+        }
+    };
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <memory>
+
+namespace QLUtils {
+    // explicit valuation context (as-of date) passed through instruments, schedulers, and bootstrappers
+    // an empty context falls back to the global QuantLib::Settings::instance().evaluationDate()
+    class ValuationContext {
+    protected:
+        QuantLib::Date asOfDate_;
+    public:
+        ValuationContext(
+            const QuantLib::Date& asOfDate = QuantLib::Date()    // empty => global evaluation date
+        ) : asOfDate_(asOfDate) {}
+        const QuantLib::Date& asOfDate() const {
+            return asOfDate_;
+        }
+        QuantLib::Date& asOfDate() {
+            return asOfDate_;
+        }
+        // true if the context carries its own as-of date, false if it falls back to the global evaluation date
+        bool isExplicit() const {
+            return (asOfDate_ != QuantLib::Date());
+        }
+        // the as-of date, or the global evaluation date if the as-of date is not set
+        QuantLib::Date evaluationDate() const {
+            return (isExplicit() ? asOfDate_ : (QuantLib::Date)QuantLib::Settings::instance().evaluationDate());
+        }
+        // today if given, otherwise the context's evaluation date
+        QuantLib::Date today(
+            const QuantLib::Date& today
+        ) const {
+            return (today == QuantLib::Date() ? evaluationDate() : today);
+        }
+        // QuantLib's own rate helpers, bonds and swaps still read the global evaluation date while they are priced.
+        // this scope sets the global evaluation date to an explicit as-of date and restores it when it goes out of scope
+        // (per thread if QuantLib is built with QL_ENABLE_SESSIONS). it does nothing for a context without its own as-of date
+        class EvaluationDateScope {
+        private:
+            std::unique_ptr<QuantLib::SavedSettings> backup_;
+        public:
+            explicit EvaluationDateScope(
+                const ValuationContext& context
+            ) {
+                if (context.isExplicit() && (QuantLib::Date)QuantLib::Settings::instance().evaluationDate() != context.asOfDate()) {
+                    backup_.reset(new QuantLib::SavedSettings());
+                    QuantLib::Settings::instance().evaluationDate() = context.asOfDate();
+                }
+            }
+            EvaluationDateScope(const EvaluationDateScope&) = delete;
+            EvaluationDateScope& operator = (const EvaluationDateScope&) = delete;
+        };
+    };
+}
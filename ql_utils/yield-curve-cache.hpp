@@ -0,0 +1,196 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/bootstrap.hpp>
+#include <string>
+#include <sstream>
+#include <typeinfo>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <future>
+#include <exception>
+
+namespace QuantLib {
+    namespace Utils {
+        // content-addressed cache of bootstrapped curves
+        // the key is made of the template parameters, the curve reference date, the evaluation date, the day counter, the exogenous discount curve (by address,
+        // checked against a weak reference kept with the entry, so a new curve allocated at the address of a destroyed one is not mistaken for it),
+        // and the definition (BootstrapInstrument::definitionKey(), including the index and conventions of the Ibor-index instruments) and quoted value
+        // of every used instrument, so a request for the same curve is served without bootstrapping again. the interpolator is only keyed by its type, use one cache per interpolator configuration
+        // a cached curve is a frozen copy of the bootstrapped curve's nodes, detached from the rate helpers, the quotes, and the evaluation date,
+        // so it can be shared by any number of threads. it has extrapolation enabled to cover the range of the bootstrapped curve past its last pillar
+        // concurrent requests for the same missing curve bootstrap it once, the others wait for the result
+        // misses of different curves are bootstrapped in parallel only if QuantLib is built with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN, since the
+        // rate helpers of every bootstrap register with shared observables (the evaluation date, the indexes). otherwise they are bootstrapped one at a time
+        // memory is bounded by evicting the least recently used curves above the capacity
+        template <
+            typename Traits = ZeroYield,
+            typename Interpolator = Linear,
+            template<class> class Bootstrap = IterativeBootstrap
+        >
+        class YieldCurveCache {
+        public:
+            typedef YieldCurvesBootstrap<Traits, Interpolator, Bootstrap> YieldCurvesBootstrapType;
+            typedef typename YieldCurvesBootstrapType::BaseCurveType BaseCurveType;
+            typedef ext::shared_ptr<BaseCurveType> CurvePtr;
+            typedef Bootstrapper::Instruments Instruments;
+            typedef Bootstrapper::pInstruments pInstruments;
+            typedef Bootstrapper::YieldTermStructurePtr YieldTermStructurePtr;
+        private:
+            typedef std::list<std::string> LruList;
+            struct Entry {
+                std::shared_future<CurvePtr> curve;
+                typename LruList::iterator lru;
+                Size id;    // tells an entry from a later one re-inserted under the same key
+                ext::weak_ptr<YieldTermStructure> exogenousDiscountTS;  // the curve whose address is in the key
+            };
+            Size capacity_;
+            LruList lru_;   // most recently used first
+            std::unordered_map<std::string, Entry> entries_;
+            Size hits_;
+            Size misses_;
+            Size evictions_;
+            Size nextId_;
+            mutable std::mutex mutex_;
+#ifndef QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN
+            std::mutex bootstrapMutex_; // serializes the bootstraps of the misses
+#endif
+        private:
+            static std::string makeKey(
+                const Instruments& instruments,
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter,
+                const YieldTermStructurePtr& exogenousDiscountTS
+            ) {
+                std::ostringstream oss;
+                oss << std::hexfloat;   // exact quoted values
+                oss << typeid(Traits).name() << "|" << typeid(Interpolator).name() << "|" << typeid(YieldCurvesBootstrapType).name();
+                oss << "|" << curveReferenceDate.serialNumber();
+                oss << "|" << Date(Settings::instance().evaluationDate()).serialNumber();  // the rate helpers are dated from it
+                oss << "|" << (dayCounter.empty() ? std::string() : dayCounter.name());
+                oss << "|" << exogenousDiscountTS.get();
+                for (const auto& inst : instruments) {
+                    if (inst != nullptr && inst->use()) {
+                        inst->ensureValueIsSet();
+                        oss << "\n" << inst->definitionKey() << "=" << inst->value();
+                    }
+                }
+                return oss.str();
+            }
+            void evict() {  // with the lock held
+                while (entries_.size() > capacity_ && !lru_.empty()) {
+                    entries_.erase(lru_.back());
+                    lru_.pop_back();
+                    ++evictions_;
+                }
+            }
+        public:
+            YieldCurveCache(
+                Size capacity = 64  // max number of cached curves
+            ) : capacity_(capacity), hits_(0), misses_(0), evictions_(0), nextId_(0) {
+                QL_REQUIRE(capacity > 0, "curve cache capacity must be positive");
+            }
+            YieldCurveCache(const YieldCurveCache&) = delete;
+            YieldCurveCache& operator = (const YieldCurveCache&) = delete;
+            // the curve bootstrapped from the instruments, from the cache if available
+            CurvePtr curve(
+                const pInstruments& instruments,
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter = Actual365Fixed(),
+                const YieldTermStructurePtr& exogenousDiscountTS = nullptr,  // for a dual bootstrap
+                const Interpolator& interp = Interpolator()
+            ) {
+                QL_REQUIRE(instruments != nullptr, "instruments is not set");
+                auto key = makeKey(*instruments, curveReferenceDate, dayCounter, exogenousDiscountTS);
+                std::promise<CurvePtr> promise;
+                std::shared_future<CurvePtr> cached;
+                Size id = 0;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto p = entries_.find(key);
+                    if (p != entries_.end() && p->second.exogenousDiscountTS.lock() != exogenousDiscountTS) {  // keyed by the address of a destroyed discount curve
+                        lru_.erase(p->second.lru);
+                        entries_.erase(p);
+                        p = entries_.end();
+                    }
+                    if (p != entries_.end()) {
+                        ++hits_;
+                        lru_.splice(lru_.begin(), lru_, p->second.lru);
+                        cached = p->second.curve;
+                    }
+                    else {
+                        ++misses_;
+                        lru_.push_front(key);
+                        id = nextId_++;
+                        entries_[key] = Entry{promise.get_future().share(), lru_.begin(), id, exogenousDiscountTS};
+                        evict();
+                    }
+                }
+                if (cached.valid()) {
+                    return cached.get();    // waits if the curve is being bootstrapped by another request
+                }
+                try {
+#ifndef QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN
+                    std::lock_guard<std::mutex> bootstrapLock(bootstrapMutex_);
+#endif
+                    YieldCurvesBootstrapType bootstrap;
+                    bootstrap.instruments = instruments;
+                    bootstrap.exogenousDiscountTermStructure = exogenousDiscountTS;
+                    bootstrap.bootstrap(curveReferenceDate, dayCounter, interp);
+                    const auto& bootstrapped = bootstrap.estimatingCurve;
+                    CurvePtr frozen(new BaseCurveType(bootstrapped->dates(), bootstrapped->data(), dayCounter, interp));
+                    frozen->enableExtrapolation();
+                    promise.set_value(frozen);
+                    return frozen;
+                }
+                catch (...) {
+                    promise.set_exception(std::current_exception());    // for the requests already waiting on it
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto p = entries_.find(key);
+                    if (p != entries_.end() && p->second.id == id) {  // failures are not cached, but leave an entry another request re-inserted after this one was evicted
+                        lru_.erase(p->second.lru);
+                        entries_.erase(p);
+                    }
+                    throw;
+                }
+            }
+            void clear() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                entries_.clear();
+                lru_.clear();
+            }
+            Size capacity() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return capacity_;
+            }
+            void setCapacity(Size capacity) {
+                QL_REQUIRE(capacity > 0, "curve cache capacity must be positive");
+                std::lock_guard<std::mutex> lock(mutex_);
+                capacity_ = capacity;
+                evict();
+            }
+            Size size() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return entries_.size();
+            }
+            Size hits() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return hits_;
+            }
+            Size misses() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return misses_;
+            }
+            Size evictions() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return evictions_;
+            }
+            Real hitRatio() const {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto requests = hits_ + misses_;
+                return (requests == 0 ? 0.0 : Real(hits_) / requests);
+            }
+        };
+    }
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <ql/quantlib.hpp>
+#include <ql_utils/bootstrap.hpp>
+#include <ql_utils/utilities/thread-pool.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <exception>
+#include <algorithm>
+
+namespace QuantLib {
+    namespace Utils {
+        // bootstraps a set of yield curves whose dual bootstraps depend on each other through exogenousDiscountTermStructure
+        // each curve (job) may name another curve in the set as its discount curve. the jobs form a DAG, and independent jobs are
+        // bootstrapped concurrently on a thread pool as soon as their discount curve is available, so the whole set takes about
+        // as long as its longest dependency chain
+        // the jobs share the global Settings and, for dual bootstraps, observe the same discount curve from different threads.
+        // QuantLib must therefore be built with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN for numThreads > 1, and the evaluation
+        // date must not be changed while bootstrap() is running
+        class YieldCurveSetBootstrap {
+        public:
+            struct Job {
+                // input
+                std::string name;
+                YieldCurvesBootstrapPtr bootstrap;
+                std::string discountCurveName;  // empty => the job is not dependent on any other job of the set
+                // output
+                bool succeeded;
+                std::string error;
+                double elapsedSeconds;  // wall clock time of the job's own bootstrap
+                Job(
+                    const std::string& name,
+                    const YieldCurvesBootstrapPtr& bootstrap,
+                    const std::string& discountCurveName
+                ) : name(name), bootstrap(bootstrap), discountCurveName(discountCurveName), succeeded(false), elapsedSeconds(0.0) {}
+            };
+        private:
+            std::vector<Job> jobs_;
+            std::map<std::string, size_t> jobIndex_;
+            double elapsedSeconds_;
+        private:
+            // returns the discount curve parent job index of each job (Null<Size>() if none)
+            std::vector<Size> parents() const {
+                std::vector<Size> ret(jobs_.size(), Null<Size>());
+                for (Size i = 0; i < jobs_.size(); ++i) {
+                    const auto& discountCurveName = jobs_[i].discountCurveName;
+                    if (!discountCurveName.empty()) {
+                        auto p = jobIndex_.find(discountCurveName);
+                        QL_REQUIRE(p != jobIndex_.end(), "discount curve '" << discountCurveName << "' of curve '" << jobs_[i].name << "' is not in the curve set");
+                        ret[i] = p->second;
+                    }
+                }
+                return ret;
+            }
+            // Kahn's algorithm. fails if the discount curve dependencies are cyclic
+            void checkAcyclic(
+                const std::vector<Size>& parents,
+                const std::vector<std::vector<Size>>& children
+            ) const {
+                std::vector<Size> queue;
+                queue.reserve(jobs_.size());
+                for (Size i = 0; i < jobs_.size(); ++i) {
+                    if (parents[i] == Null<Size>()) {
+                        queue.push_back(i);
+                    }
+                }
+                for (Size k = 0; k < queue.size(); ++k) {
+                    for (auto child : children[queue[k]]) {
+                        queue.push_back(child);
+                    }
+                }
+                if (queue.size() < jobs_.size()) {
+                    std::vector<bool> visited(jobs_.size(), false);
+                    for (auto i : queue) {
+                        visited[i] = true;
+                    }
+                    std::ostringstream os;
+                    for (Size i = 0; i < jobs_.size(); ++i) {
+                        if (!visited[i]) {
+                            os << (os.tellp() > 0 ? ", " : "") << jobs_[i].name;
+                        }
+                    }
+                    QL_FAIL("cyclic discount curve dependency among curves: " << os.str());
+                }
+            }
+        public:
+            YieldCurveSetBootstrap() : elapsedSeconds_(0.0) {}
+            // add a curve to the set. discountCurveName names the curve (of the same set) whose estimating term structure
+            // becomes this curve's exogenous discount term structure. leave it empty to bootstrap the curve on its own
+            // (the curve's exogenousDiscountTermStructure is then left untouched)
+            YieldCurveSetBootstrap& add(
+                const std::string& name,
+                const YieldCurvesBootstrapPtr& bootstrap,
+                const std::string& discountCurveName = ""
+            ) {
+                QL_REQUIRE(!name.empty(), "curve name cannot be empty");
+                QL_REQUIRE(bootstrap != nullptr, "bootstrap of curve '" << name << "' cannot be null");
+                QL_REQUIRE(jobIndex_.find(name) == jobIndex_.end(), "curve '" << name << "' is already in the curve set");
+                QL_REQUIRE(discountCurveName != name, "curve '" << name << "' cannot be its own discount curve");
+                jobIndex_[name] = jobs_.size();
+                jobs_.emplace_back(name, bootstrap, discountCurveName);
+                return *this;
+            }
+            const std::vector<Job>& jobs() const {
+                return jobs_;
+            }
+            const YieldCurvesBootstrapPtr& operator [] (const std::string& name) const {
+                auto p = jobIndex_.find(name);
+                QL_REQUIRE(p != jobIndex_.end(), "curve '" << name << "' is not in the curve set");
+                return jobs_[p->second].bootstrap;
+            }
+            // wall clock time of the last bootstrap() call
+            double elapsedSeconds() const {
+                return elapsedSeconds_;
+            }
+            // bootstrap all curves of the set using the given thread pool
+            // all curves are attempted. curves whose discount curve failed are skipped. if any curve failed or was skipped,
+            // an error listing all of them is thrown at the end (the individual outcomes remain available through jobs())
+            void bootstrap(
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter,
+                QLUtils::ThreadPool& pool
+            ) {
+                typedef std::chrono::steady_clock Clock;
+                auto start = Clock::now();
+                auto parents = this->parents();
+                std::vector<std::vector<Size>> children(jobs_.size());
+                for (Size i = 0; i < jobs_.size(); ++i) {
+                    if (parents[i] != Null<Size>()) {
+                        children[parents[i]].push_back(i);
+                    }
+                }
+                checkAcyclic(parents, children);
+                for (auto& job : jobs_) {
+                    job.succeeded = false;
+                    job.error.clear();
+                    job.elapsedSeconds = 0.0;
+                }
+                std::mutex mutex;   // guards the job outputs
+                std::function<void(Size)> skip = [&](Size i) {
+                    for (auto child : children[i]) {
+                        jobs_[child].error = "skipped, discount curve '" + jobs_[i].name + "' failed";
+                        skip(child);
+                    }
+                };
+                std::function<void(Size)> run = [&](Size i) {
+                    auto& job = jobs_[i];
+                    auto jobStart = Clock::now();
+                    std::string error;
+                    try {
+                        if (parents[i] != Null<Size>()) {
+                            job.bootstrap->exogenousDiscountTermStructure = jobs_[parents[i]].bootstrap->estimatingTermStructure();
+                        }
+                        job.bootstrap->piecewiseBootstrap(curveReferenceDate, dayCounter);
+                    }
+                    catch (const std::exception& e) {
+                        error = e.what();
+                    }
+                    catch (...) {
+                        error = "unknown error";
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    job.elapsedSeconds = std::chrono::duration<double>(Clock::now() - jobStart).count();
+                    job.succeeded = error.empty();
+                    job.error = error;
+                    if (job.succeeded) {
+                        for (auto child : children[i]) {
+                            pool.submit([&run, child]() {run(child);});
+                        }
+                    }
+                    else {
+                        skip(i);
+                    }
+                };
+                for (Size i = 0; i < jobs_.size(); ++i) {
+                    if (parents[i] == Null<Size>()) {
+                        pool.submit([&run, i]() {run(i);});
+                    }
+                }
+                pool.wait();
+                elapsedSeconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+                std::ostringstream os;
+                Size numFailed = 0;
+                for (const auto& job : jobs_) {
+                    if (!job.succeeded) {
+                        os << std::endl << job.name << ": " << job.error;
+                        ++numFailed;
+                    }
+                }
+                QL_REQUIRE(numFailed == 0, numFailed << " of " << jobs_.size() << " curve bootstrap(s) failed" << os.str());
+            }
+            // bootstrap all curves of the set on a dedicated pool of numThreads workers (0 => one per hardware thread)
+            void bootstrap(
+                const Date& curveReferenceDate,
+                const DayCounter& dayCounter = Actual365Fixed(),
+                Size numThreads = 0
+            ) {
+                if (numThreads == 0) {
+                    numThreads = QLUtils::ThreadPool::defaultConcurrency();
+                }
+                QLUtils::ThreadPool pool(std::max<Size>(1, std::min<Size>(numThreads, jobs_.size())));
+                bootstrap(curveReferenceDate, dayCounter, pool);
+            }
+        };
+    }
+}
@@ -0,0 +1,99 @@
+// historical batch bootstrap test: the curves a HistoricalBatchBootstrap hands to its result handler must be the curves of
+// their market date, although the handler runs after the evaluation date has been restored
+// inside the handler each date's discount factors are checked against a bootstrap of the same quotes done directly on that date
+// prints one line per date and exits with a non-zero status if any check fails
+// usage: historical-batch-bootstrap-test
+// build: g++ -std=c++17 -O2 -I<repo root> tests/historical-batch-bootstrap-test.cpp -lQuantLib -pthread
+#include <ql/quantlib.hpp>
+#include <ql_utils/all.hpp>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace QuantLib;
+using namespace QuantLib::Utils;
+
+namespace {
+    typedef Bootstrapper::Instruments Instruments;
+    typedef Bootstrapper::pInstruments pInstruments;
+    typedef YieldCurvesBootstrap<ZeroYield, Linear> CurveBootstrap;
+
+    const Real tolerance = 1.0e-12;
+
+    // SOFR deposit + SOFR OIS swaps, with quotes that move with the market date
+    pInstruments sofrOIS(const Date& date) {
+        typedef QLUtils::OISSwapIndex<UsdOvernightIndexedSwapIsdaFix<Sofr>> SofrOIS;
+        pInstruments instruments(new Instruments());
+        instruments->emplace_back(new QLUtils::IborIndexCashDeposit<Sofr>());
+        for (Integer m : {1, 3, 6, 12}) {
+            instruments->emplace_back(new SofrOIS(m * Months));
+        }
+        for (Integer y : {2, 3, 5, 7, 10, 20, 30}) {
+            instruments->emplace_back(new SofrOIS(y * Years));
+        }
+        Rate rate = 0.040 + 0.0001 * (date.dayOfMonth() % 7);
+        for (auto& inst : *instruments) {
+            inst->value() = rate;
+            rate += 0.0005;
+        }
+        return instruments;
+    }
+
+    // builds and bootstraps the curve of a market date, with the global evaluation date set to it
+    YieldCurvesBootstrapPtr bootstrapOn(const Date& date) {
+        std::shared_ptr<CurveBootstrap> bootstrap(new CurveBootstrap());
+        bootstrap->instruments = sofrOIS(date);
+        bootstrap->bootstrap(date);
+        return bootstrap;
+    }
+
+    std::vector<DiscountFactor> discountFactors(const YieldTermStructure& ts, const Date& date) {
+        std::vector<DiscountFactor> dfs;
+        for (Integer m : {1, 6, 12, 24, 60, 120, 240, 360}) {
+            dfs.push_back(ts.discount(date + m * Months));
+        }
+        return dfs;
+    }
+}
+
+int main() {
+    try {
+        Date globalDate(3, June, 2024);
+        Settings::instance().evaluationDate() = globalDate;
+        std::vector<Date> dates;
+        for (Date d(4, March, 2024); dates.size() < 5; d = TARGET().advance(d, 1, Days)) {
+            dates.push_back(d);
+        }
+        bool ok = true;
+        HistoricalBatchBootstrap<> batch;
+        batch.run(dates, bootstrapOn, [&ok](HistoricalBatchBootstrap<>::DateResult& result) {
+            if (!result.succeeded) {
+                std::cout << "FAIL " << result.date << " " << result.error << std::endl;
+                ok = false;
+                return;
+            }
+            auto actual = discountFactors(*result.curves->estimatingTermStructure(), result.date);
+            std::vector<DiscountFactor> expected;
+            {
+                SavedSettings backup;
+                Settings::instance().evaluationDate() = result.date;
+                auto direct = bootstrapOn(result.date);
+                expected = discountFactors(*direct->estimatingTermStructure(), result.date);
+            }
+            Real maxDiff = 0.0;
+            for (Size i = 0; i < actual.size(); ++i) {
+                maxDiff = std::max(maxDiff, std::fabs(actual[i] - expected[i]));
+            }
+            bool dateOk = (maxDiff <= tolerance);
+            std::cout << (dateOk ? "ok   " : "FAIL ") << result.date << " max diff=" << maxDiff << std::endl;
+            ok = dateOk && ok;
+        });
+        std::cout << (ok ? "passed" : "FAILED") << std::endl;
+        return (ok ? 0 : 1);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}
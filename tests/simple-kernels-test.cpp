@@ -0,0 +1,227 @@
+// simple kernels test: the monthly simple curve calculations run on the batch math kernels (SimpleMathKernels) are checked, with
+// the scalar kernels and with every wider instruction set the CPU supports, against a reference written with std::pow() only:
+// - SimpleParRateCalculator::operator() and grid(), spot and forward, and SimpleParYieldTSBootstrapper::monthlyParYields()
+// - the running annuity strip (RunningAnnuity and the allocation free bootstrap()) against the full annuity strip (FullAnnuity)
+// - SimpleForwardZeroConverter forward curves and the forward to zero bootstrap
+// - the SimpleScenarioBatchEngine par yields and strip over parallel shifts of the curve
+// the instruction set is selected per thread through SimpleMathKernels::IsaScope
+// prints one line per check and instruction set and exits with a non-zero status if any difference is over its tolerance
+// usage: simple-kernels-test
+// build: g++ -std=c++17 -O2 -I<repo root> tests/simple-kernels-test.cpp -lQuantLib -pthread
+#include <ql/quantlib.hpp>
+#include <ql_utils/simple/all.hpp>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace QLUtils;
+
+namespace {
+    typedef SimpleParRateCalculator<> ParRateCalculator;
+    typedef SimpleParYieldTSBootstrapper<> ParYieldTSBootstrapper;
+    typedef SimpleForwardZeroConverter<> ForwardZeroConverter;
+    typedef SimpleScenarioBatchEngine<> ScenarioBatchEngine;
+
+    const double freq = 2.;   // Semiannual
+    const size_t cpnIntrvlMonths = 6;
+    const size_t lastMonth = 360;
+    const double tolerance = 1.0e-10;   // in percent, ie: 1e-12 in decimal
+
+    // smooth, upward sloping monthly zero curve in percent
+    MonthlyZeroRates zeroCurve() {
+        MonthlyZeroRates zeroRates(lastMonth + 1);
+        for (size_t m = 0; m <= lastMonth; ++m) {
+            auto t = m / 12.;
+            zeroRates[m] = 3.5 + 1.2 * (1. - std::exp(-t / 4.)) - 0.4 * t * std::exp(-t / 2.);
+        }
+        return zeroRates;
+    }
+
+    double referenceDiscount(const MonthlyZeroRates& zeroRates, size_t month) {
+        auto t = month / 12.;
+        return std::pow(1. + zeroRates[month] / 100. / freq, -t * freq);
+    }
+
+    // the par yield of the original SimpleParRateCalculator::operator(), std::pow() discount factors and a coupon by coupon annuity
+    double referenceParYield(const MonthlyZeroRates& zeroRates, size_t tenorMonth, size_t fwdMonth) {
+        auto lastRelevantMonth = fwdMonth + tenorMonth;
+        auto df_0 = referenceDiscount(zeroRates, fwdMonth);
+        if (tenorMonth <= 12) {
+            if (fwdMonth == 0) {
+                return zeroRates[tenorMonth];
+            }
+            auto df = referenceDiscount(zeroRates, lastRelevantMonth) / df_0;
+            auto t = tenorMonth / 12.;
+            return (std::pow(df, -1. / (t * freq)) - 1.) * freq * 100.;
+        }
+        auto start = fwdMonth + (tenorMonth % cpnIntrvlMonths == 0 ? cpnIntrvlMonths : tenorMonth % cpnIntrvlMonths);
+        auto prevMonth = fwdMonth;
+        auto lastDf = 1.;
+        auto sum = 0.;
+        for (auto month = start; month <= lastRelevantMonth; month += cpnIntrvlMonths) {
+            auto df = referenceDiscount(zeroRates, month) / df_0;
+            sum += (month - prevMonth) / 12. * df;
+            prevMonth = month;
+            lastDf = df;
+        }
+        return (1. - lastDf) / sum * 100.;
+    }
+
+    // simple (NominalSimpleImpliedRateCalculator) forward rate in percent
+    double referenceForward(const MonthlyZeroRates& zeroRates, size_t tenorMonth, size_t fwdMonth) {
+        auto compounding = referenceDiscount(zeroRates, fwdMonth) / referenceDiscount(zeroRates, fwdMonth + tenorMonth);
+        return (compounding - 1.) / (tenorMonth / 12.) * 100.;
+    }
+
+    class Checker {
+    private:
+        std::string isaName_;
+        bool ok_;
+    public:
+        Checker() : ok_(true) {}
+        void setIsa(SimpleKernelIsa isa) {
+            std::ostringstream oss;
+            oss << isa;
+            isaName_ = oss.str();
+        }
+        void check(const std::string& name, double maxDiff) {
+            bool ok = (maxDiff <= tolerance);   // false for a NaN difference
+            std::cout << (ok ? "ok   " : "FAIL ") << isaName_ << " " << name << " max diff=" << maxDiff << std::endl;
+            ok_ = ok_ && ok;
+        }
+        bool ok() const {
+            return ok_;
+        }
+    };
+
+    double maxDiff(const std::vector<double>& actual, const std::vector<double>& expected, size_t first = 0) {
+        if (actual.size() != expected.size()) {
+            return INFINITY;
+        }
+        double diff = 0.;
+        for (size_t i = first; i < actual.size(); ++i) {
+            diff = std::max(diff, std::fabs(actual[i] - expected[i]));
+        }
+        return diff;
+    }
+
+    void checkParYields(const MonthlyZeroRates& zeroRates, Checker& checker) {
+        ParRateCalculator calculator(zeroRates);
+        double spot = 0., fwd = 0.;
+        for (size_t tenorMonth = 1; tenorMonth <= lastMonth; ++tenorMonth) {
+            spot = std::max(spot, std::fabs(calculator(tenorMonth) - referenceParYield(zeroRates, tenorMonth, 0)));
+        }
+        for (size_t fwdMonth : {1, 5, 12, 37, 120}) {
+            for (size_t tenorMonth = 1; fwdMonth + tenorMonth <= lastMonth; ++tenorMonth) {
+                fwd = std::max(fwd, std::fabs(calculator(tenorMonth, fwdMonth) - referenceParYield(zeroRates, tenorMonth, fwdMonth)));
+            }
+        }
+        checker.check("par rate calculator spot", spot);
+        checker.check("par rate calculator forward", fwd);
+        QuantLib::Matrix grid(121, 240);
+        calculator.grid(grid);
+        double gridDiff = 0.;
+        for (size_t fwdMonth = 0; fwdMonth < grid.rows(); ++fwdMonth) {
+            for (size_t tenorMonth = 1; tenorMonth <= grid.columns(); ++tenorMonth) {
+                if (fwdMonth + tenorMonth <= lastMonth) {
+                    gridDiff = std::max(gridDiff, std::fabs(grid[fwdMonth][tenorMonth - 1] - referenceParYield(zeroRates, tenorMonth, fwdMonth)));
+                }
+            }
+        }
+        checker.check("par rate calculator grid", gridDiff);
+        std::vector<double> parYields(zeroRates.size()), expected(zeroRates.size()), annuities;
+        ParYieldTSBootstrapper::monthlyParYields(zeroRates, parYields, annuities);
+        for (size_t tenorMonth = 1; tenorMonth <= lastMonth; ++tenorMonth) {
+            expected[tenorMonth] = referenceParYield(zeroRates, tenorMonth, 0);
+        }
+        checker.check("monthly par yields", maxDiff(parYields, expected, 1));
+    }
+
+    void checkParStrip(const MonthlyZeroRates& zeroRates, Checker& checker) {
+        std::vector<size_t> maturityMonths = {1, 3, 6, 12, 24, 36, 60, 84, 120, 240, 360};
+        std::vector<double> parYields;
+        for (auto month : maturityMonths) {
+            parYields.push_back(referenceParYield(zeroRates, month, 0));
+        }
+        ParYieldTSBootstrapper fullAnnuity(maturityMonths, parYields);
+        fullAnnuity.strippingMode = ParYieldTSBootstrapper::FullAnnuity;
+        fullAnnuity.bootstrap();
+        ParYieldTSBootstrapper runningAnnuity(maturityMonths, parYields);
+        runningAnnuity.strippingMode = ParYieldTSBootstrapper::RunningAnnuity;
+        runningAnnuity.bootstrap();
+        const auto& expected = *fullAnnuity.pMonthlyZeroRates;
+        checker.check("running annuity strip", maxDiff(*runningAnnuity.pMonthlyZeroRates, expected));
+        ParYieldTSBootstrapper::Workspace workspace;
+        std::vector<double> zeroRatesOut(maturityMonths.back() + 1);
+        ParYieldTSBootstrapper::bootstrap(maturityMonths, parYields, zeroRatesOut, workspace);
+        checker.check("allocation free strip", maxDiff(zeroRatesOut, expected));
+    }
+
+    void checkForwards(const MonthlyZeroRates& zeroRates, Checker& checker) {
+        double fwdDiff = 0.;
+        for (size_t tenorMonth : {1, 3, 12, 120}) {
+            auto fwdCurve = ForwardZeroConverter::forwardCurve(zeroRates, tenorMonth);
+            for (size_t fwdMonth = 0; fwdMonth < fwdCurve->size(); ++fwdMonth) {
+                fwdDiff = std::max(fwdDiff, std::fabs((*fwdCurve)[fwdMonth] - referenceForward(zeroRates, tenorMonth, fwdMonth)));
+            }
+        }
+        checker.check("forward curves", fwdDiff);
+        MonthlyForwardCurve monthlyFwdCurve(lastMonth);
+        for (size_t fwdMonth = 0; fwdMonth < lastMonth; ++fwdMonth) {
+            monthlyFwdCurve[fwdMonth] = referenceForward(zeroRates, 1, fwdMonth);
+        }
+        auto bootstrapped = ForwardZeroConverter::bootstrap(monthlyFwdCurve);
+        checker.check("forward bootstrap", maxDiff(*bootstrapped, zeroRates, 1));   // month 0 is set to month 1
+    }
+
+    void checkBatch(const MonthlyZeroRates& zeroRates, Checker& checker) {
+        const size_t nScenarios = 17;   // enough to fill the widest vectors, with a remainder
+        SimpleScenarioMatrix scenarios, parYields, stripped;
+        scenarios.resize(nScenarios, zeroRates.size());
+        std::vector<MonthlyZeroRates> curves(nScenarios, zeroRates);
+        for (size_t s = 0; s < nScenarios; ++s) {
+            auto shift = ((double)s - 8.) * 0.125;
+            for (size_t m = 0; m <= lastMonth; ++m) {
+                curves[s][m] += shift;
+                scenarios(s, m) = curves[s][m];
+            }
+        }
+        ScenarioBatchEngine engine;
+        engine.parYields(scenarios, parYields);
+        engine.zeroRatesFromParYields(parYields, stripped);
+        double parDiff = 0., stripDiff = 0.;
+        for (size_t s = 0; s < nScenarios; ++s) {
+            for (size_t m = 1; m <= lastMonth; ++m) {
+                parDiff = std::max(parDiff, std::fabs(parYields(s, m) - referenceParYield(curves[s], m, 0)));
+                stripDiff = std::max(stripDiff, std::fabs(stripped(s, m) - curves[s][m]));
+            }
+        }
+        checker.check("batch par yields", parDiff);
+        checker.check("batch par strip", stripDiff);
+    }
+}
+
+int main() {
+    try {
+        auto zeroRates = zeroCurve();
+        Checker checker;
+        for (int i = (int)ScalarKernels; i <= (int)SimpleMathKernels::detectedIsa(); ++i) {
+            auto isa = (SimpleKernelIsa)i;
+            SimpleMathKernels::IsaScope isaScope(isa);
+            checker.setIsa(isa);
+            checkParYields(zeroRates, checker);
+            checkParStrip(zeroRates, checker);
+            checkForwards(zeroRates, checker);
+            checkBatch(zeroRates, checker);
+        }
+        std::cout << (checker.ok() ? "passed" : "FAILED") << std::endl;
+        return (checker.ok() ? 0 : 1);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,116 @@
+// valuation context test: a YieldCurvesBootstrap with an explicit valuation context must produce curves that do not move
+// when the global evaluation date changes after bootstrap() or rebootstrap() returns
+// the discount factors are checked against a bootstrap of the same quotes done with the global evaluation date set to the as-of date
+// prints one line per check and exits with a non-zero status if any check fails
+// usage: valuation-context-test
+// build: g++ -std=c++17 -O2 -I<repo root> tests/valuation-context-test.cpp -lQuantLib -pthread
+#include <ql/quantlib.hpp>
+#include <ql_utils/all.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace QuantLib;
+using namespace QuantLib::Utils;
+
+namespace {
+    typedef Bootstrapper::Instruments Instruments;
+    typedef Bootstrapper::pInstruments pInstruments;
+    typedef YieldCurvesBootstrap<ZeroYield, Linear> CurveBootstrap;
+
+    const Real tolerance = 1.0e-12;
+
+    // SOFR deposit + SOFR OIS swaps
+    pInstruments sofrOIS() {
+        typedef QLUtils::OISSwapIndex<UsdOvernightIndexedSwapIsdaFix<Sofr>> SofrOIS;
+        pInstruments instruments(new Instruments());
+        instruments->emplace_back(new QLUtils::IborIndexCashDeposit<Sofr>());
+        for (Integer m : {1, 3, 6, 12}) {
+            instruments->emplace_back(new SofrOIS(m * Months));
+        }
+        for (Integer y : {2, 3, 5, 7, 10, 20, 30}) {
+            instruments->emplace_back(new SofrOIS(y * Years));
+        }
+        Rate rate = 0.040;
+        for (auto& inst : *instruments) {
+            inst->value() = rate;
+            rate += 0.0005;
+        }
+        return instruments;
+    }
+
+    std::vector<Date> checkDates(const Date& asOfDate) {
+        std::vector<Date> dates;
+        for (Integer m : {1, 6, 12, 24, 60, 120, 240, 360}) {
+            dates.push_back(asOfDate + m * Months);
+        }
+        return dates;
+    }
+
+    std::vector<DiscountFactor> discountFactors(const YieldTermStructure& ts, const std::vector<Date>& dates) {
+        std::vector<DiscountFactor> dfs;
+        for (const auto& d : dates) {
+            dfs.push_back(ts.discount(d));
+        }
+        return dfs;
+    }
+
+    bool check(const std::string& name, const std::vector<DiscountFactor>& actual, const std::vector<DiscountFactor>& expected) {
+        Real maxDiff = 0.0;
+        for (Size i = 0; i < actual.size(); ++i) {
+            maxDiff = std::max(maxDiff, std::fabs(actual[i] - expected[i]));
+        }
+        bool ok = (actual.size() == expected.size() && maxDiff <= tolerance);
+        std::cout << (ok ? "ok   " : "FAIL ") << name << " max diff=" << maxDiff << std::endl;
+        return ok;
+    }
+
+    // discount factors of a bootstrap done the legacy way, with the global evaluation date set to the as-of date
+    std::vector<DiscountFactor> globalDateDiscountFactors(const pInstruments& instruments, const Date& asOfDate, const std::vector<Date>& dates) {
+        SavedSettings backup;
+        Settings::instance().evaluationDate() = asOfDate;
+        CurveBootstrap bootstrap;
+        bootstrap.instruments = instruments;
+        bootstrap.bootstrap(asOfDate);
+        return discountFactors(*bootstrap.estimatingCurve, dates);
+    }
+}
+
+int main() {
+    try {
+        Date asOfDate(15, March, 2024);
+        Date globalDate(3, June, 2024);
+        Settings::instance().evaluationDate() = globalDate;
+        auto dates = checkDates(asOfDate);
+        auto instruments = sofrOIS();
+        bool ok = true;
+
+        CurveBootstrap bootstrap;
+        bootstrap.instruments = instruments;
+        bootstrap.valuationContext = QLUtils::ValuationContext(asOfDate);
+        bootstrap.bootstrap(asOfDate);
+        auto expected = globalDateDiscountFactors(instruments, asOfDate, dates);
+        ok = check("bootstrap, global date unchanged", discountFactors(*bootstrap.estimatingCurve, dates), expected) && ok;
+        Settings::instance().evaluationDate() = globalDate + 7;
+        ok = check("bootstrap, global date moved", discountFactors(*bootstrap.estimatingCurve, dates), expected) && ok;
+        ok = check("bootstrap, discount curve", discountFactors(*bootstrap.discountCurve, dates), expected) && ok;
+
+        for (auto& inst : *instruments) {
+            inst->value() += 0.0010;
+        }
+        bootstrap.rebootstrap();
+        expected = globalDateDiscountFactors(instruments, asOfDate, dates);
+        ok = check("rebootstrap, global date unchanged", discountFactors(*bootstrap.estimatingCurve, dates), expected) && ok;
+        Settings::instance().evaluationDate() = globalDate + 30;
+        ok = check("rebootstrap, global date moved", discountFactors(*bootstrap.estimatingCurve, dates), expected) && ok;
+
+        std::cout << (ok ? "passed" : "FAILED") << std::endl;
+        return (ok ? 0 : 1);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}